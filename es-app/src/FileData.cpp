@@ -1,5 +1,9 @@
 #include "FileData.h"
 #include "SystemData.h"
+#include "ThreadPool.h"
+
+// below this many files in total, starting and joining the threads costs more than sorting on one
+#define PARALLEL_SORT_MIN_FILES 10000
 
 namespace fs = boost::filesystem;
 
@@ -44,11 +48,14 @@ std::string removeParenthesis(const std::string& str)
 
 
 FileData::FileData(FileType type, const fs::path& path, SystemData* system)
-	: mType(type), mPath(path), mSystem(system), mParent(NULL), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA), mType(type), mPath(path), mSystem(system), mParent(NULL), mGameCount(0), mFolderCount(0) // metadata is REALLY set in the constructor!
 {
 	// metadata needs at least a name field (since that's what getName() will return)
 	if(metadata.get("name").empty())
 		metadata.set("name", getCleanName());
+
+	// a freshly scanned file has nothing worth saving yet
+	metadata.resetChangedFlag();
 }
 
 FileData::~FileData()
@@ -81,20 +88,43 @@ const std::string& FileData::getThumbnailPath() const
 std::vector<FileData*> FileData::getFilesRecursive(unsigned int typeMask) const
 {
 	std::vector<FileData*> out;
+	out.reserve(getCountRecursive(typeMask));
 
-	for(auto it = mChildren.begin(); it != mChildren.end(); it++)
+	visitFilesRecursive(typeMask, [&out](FileData* file) -> bool {
+		out.push_back(file);
+		return true;
+	});
+
+	return out;
+}
+
+unsigned int FileData::getCountRecursive(unsigned int typeMask) const
+{
+	unsigned int count = 0;
+	if(typeMask & GAME)
+		count += mGameCount;
+	if(typeMask & FOLDER)
+		count += mFolderCount;
+
+	return count;
+}
+
+void FileData::updateCounts(const FileData* file, int sign)
+{
+	const unsigned int games = file->mGameCount + (file->mType == GAME ? 1 : 0);
+	const unsigned int folders = file->mFolderCount + (file->mType == FOLDER ? 1 : 0);
+
+	for(FileData* folder = this; folder != NULL; folder = folder->mParent)
 	{
-		if((*it)->getType() & typeMask)
-			out.push_back(*it);
-		
-		if((*it)->getChildren().size() > 0)
+		if(sign > 0)
 		{
-			std::vector<FileData*> subchildren = (*it)->getFilesRecursive(typeMask);
-			out.insert(out.end(), subchildren.cbegin(), subchildren.cend());
+			folder->mGameCount += games;
+			folder->mFolderCount += folders;
+		}else{
+			folder->mGameCount -= games;
+			folder->mFolderCount -= folders;
 		}
 	}
-
-	return out;
 }
 
 void FileData::addChild(FileData* file)
@@ -103,7 +133,9 @@ void FileData::addChild(FileData* file)
 	assert(file->getParent() == NULL);
 
 	mChildren.push_back(file);
+	mChildrenByFilename.emplace(file->getPath().filename().string(), file); // keep the first one if there's somehow a duplicate
 	file->mParent = this;
+	updateCounts(file, 1);
 }
 
 void FileData::removeChild(FileData* file)
@@ -116,6 +148,12 @@ void FileData::removeChild(FileData* file)
 		if(*it == file)
 		{
 			mChildren.erase(it);
+
+			auto indexed = mChildrenByFilename.find(file->getPath().filename().string());
+			if(indexed != mChildrenByFilename.end() && indexed->second == file)
+				mChildrenByFilename.erase(indexed);
+
+			updateCounts(file, -1);
 			return;
 		}
 	}
@@ -124,6 +162,12 @@ void FileData::removeChild(FileData* file)
 	assert(false);
 }
 
+FileData* FileData::findChild(const std::string& filename) const
+{
+	auto it = mChildrenByFilename.find(filename);
+	return it != mChildrenByFilename.end() ? it->second : NULL;
+}
+
 void FileData::sort(ComparisonFunction& comparator, bool ascending)
 {
 	std::sort(mChildren.begin(), mChildren.end(), comparator);
@@ -138,7 +182,63 @@ void FileData::sort(ComparisonFunction& comparator, bool ascending)
 		std::reverse(mChildren.begin(), mChildren.end());
 }
 
-void FileData::sort(const SortType& type)
+void FileData::sortChildren(const SortType& type)
 {
-	sort(*type.comparisonFunction, type.ascending);
+	struct KeyedFile
+	{
+		SortKey key;
+		FileData* file;
+	};
+
+	std::vector<KeyedFile> keyed(mChildren.size());
+	for(unsigned int i = 0; i < mChildren.size(); i++)
+	{
+		keyed[i].key.number = 0;
+		keyed[i].key.valid = true;
+		type.keyFunction(mChildren[i], keyed[i].key);
+		keyed[i].file = mChildren[i];
+	}
+
+	KeyComparisonFunction* compare = type.keyComparisonFunction;
+	std::sort(keyed.begin(), keyed.end(), [compare](const KeyedFile& a, const KeyedFile& b) { return compare(a.key, b.key); });
+
+	for(unsigned int i = 0; i < keyed.size(); i++)
+		mChildren[i] = keyed[i].file;
+
+	if(!type.ascending)
+		std::reverse(mChildren.begin(), mChildren.end());
+}
+
+void FileData::sort(const SortType& type, bool useThreads)
+{
+	// every folder that has something to sort, including us
+	std::vector<FileData*> folders;
+	folders.push_back(this);
+	size_t fileCount = 0;
+	for(unsigned int i = 0; i < folders.size(); i++)
+	{
+		const std::vector<FileData*>& children = folders[i]->mChildren;
+		fileCount += children.size();
+		for(auto it = children.begin(); it != children.end(); it++)
+		{
+			if((*it)->getChildren().size() > 0)
+				folders.push_back(*it);
+		}
+	}
+
+	if(!useThreads || folders.size() == 1 || fileCount < PARALLEL_SORT_MIN_FILES)
+	{
+		for(auto it = folders.begin(); it != folders.end(); it++)
+			(*it)->sortChildren(type);
+		return;
+	}
+
+	// each job only touches one folder's list of children, so they can't step on each other
+	ThreadPool pool;
+	for(auto it = folders.begin(); it != folders.end(); it++)
+	{
+		FileData* folder = *it;
+		pool.queueWork([folder, &type] { folder->sortChildren(type); });
+	}
+	pool.wait();
 }
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <atomic>
 #include <boost/filesystem.hpp>
 #include "MetaData.h"
 
@@ -46,6 +48,30 @@ public:
 
 	std::vector<FileData*> getFilesRecursive(unsigned int typeMask) const;
 
+	// Number of descendants matching typeMask. Kept up to date by addChild()/removeChild(), so this doesn't walk the tree.
+	unsigned int getCountRecursive(unsigned int typeMask) const;
+
+	// Calls visitor(FileData*) for every descendant matching typeMask, in the same order as getFilesRecursive(),
+	// without building a vector. The visitor returns false to stop early, in which case this returns false too.
+	// Don't add or remove files from inside the visitor.
+	template<typename Visitor>
+	bool visitFilesRecursive(unsigned int typeMask, const Visitor& visitor) const
+	{
+		for(auto it = mChildren.begin(); it != mChildren.end(); it++)
+		{
+			if(((*it)->mType & typeMask) && !visitor(*it))
+				return false;
+
+			if(!(*it)->mChildren.empty() && !(*it)->visitFilesRecursive(typeMask, visitor))
+				return false;
+		}
+
+		return true;
+	}
+
+	// Returns the child whose path ends in filename, or NULL if there isn't one.
+	FileData* findChild(const std::string& filename) const;
+
 	void addChild(FileData* file); // Error if mType != FOLDER
 	void removeChild(FileData* file); //Error if mType != FOLDER
 
@@ -53,25 +79,55 @@ public:
 	std::string getCleanName() const;
 
 	typedef bool ComparisonFunction(const FileData* a, const FileData* b);
+
+	// What a sort actually compares (e.g. the upper-cased name or the rating), pulled out of each file once per sort
+	// instead of twice per comparison.
+	struct SortKey
+	{
+		std::string text;
+		double number;
+		bool valid; // false if this file doesn't have the value (e.g. folders have no rating) - it won't be ordered against anything
+	};
+	typedef void KeyFunction(const FileData* file, SortKey& key);
+	typedef bool KeyComparisonFunction(const SortKey& a, const SortKey& b);
+
 	struct SortType
 	{
 		ComparisonFunction* comparisonFunction;
+		KeyFunction* keyFunction;
+		KeyComparisonFunction* keyComparisonFunction;
 		bool ascending;
 		std::string description;
 
-		SortType(ComparisonFunction* sortFunction, bool sortAscending, const std::string & sortDescription) 
-			: comparisonFunction(sortFunction), ascending(sortAscending), description(sortDescription) {}
+		SortType(ComparisonFunction* sortFunction, KeyFunction* sortKeyFunction, KeyComparisonFunction* sortKeyComparisonFunction, 
+			bool sortAscending, const std::string & sortDescription) 
+			: comparisonFunction(sortFunction), keyFunction(sortKeyFunction), keyComparisonFunction(sortKeyComparisonFunction), 
+			ascending(sortAscending), description(sortDescription) {}
 	};
 
 	void sort(ComparisonFunction& comparator, bool ascending = true);
-	void sort(const SortType& type);
+
+	// Sorts using the type's keys. Folders are independent of each other, so if useThreads is set and there's more than one
+	// (and enough files to be worth starting threads for), they're sorted in parallel (don't set it if you're already on a ThreadPool worker).
+	void sort(const SortType& type, bool useThreads = true);
 
 	MetaDataList metadata;
 
 private:
+	// Sorts our children, but not theirs.
+	void sortChildren(const SortType& type);
+
+	// Adds (or with a negative sign, removes) file and everything under it to our counts and our parents'.
+	void updateCounts(const FileData* file, int sign);
+
 	FileType mType;
 	boost::filesystem::path mPath;
 	SystemData* mSystem;
 	FileData* mParent;
 	std::vector<FileData*> mChildren;
+	std::unordered_map<std::string, FileData*> mChildrenByFilename;
+
+	// descendant counts - atomic because folders are populated by several scan threads at once, and they all count towards the root
+	std::atomic<unsigned int> mGameCount;
+	std::atomic<unsigned int> mFolderCount;
 };
@@ -1,19 +1,20 @@
 #include "FileSorts.h"
+#include <algorithm>
 
 namespace FileSorts
 {
 	const FileData::SortType typesArr[] = {
-		FileData::SortType(&compareFileName, true, "filename, ascending"),
-		FileData::SortType(&compareFileName, false, "filename, descending"),
+		FileData::SortType(&compareFileName, &fileNameKey, &compareTextKey, true, "filename, ascending"),
+		FileData::SortType(&compareFileName, &fileNameKey, &compareTextKey, false, "filename, descending"),
 
-		FileData::SortType(&compareRating, true, "rating, ascending"),
-		FileData::SortType(&compareRating, false, "rating, descending"),
+		FileData::SortType(&compareRating, &ratingKey, &compareNumberKey, true, "rating, ascending"),
+		FileData::SortType(&compareRating, &ratingKey, &compareNumberKey, false, "rating, descending"),
 
-		FileData::SortType(&compareTimesPlayed, true, "times played, ascending"),
-		FileData::SortType(&compareTimesPlayed, false, "times played, descending"),
+		FileData::SortType(&compareTimesPlayed, &timesPlayedKey, &compareNumberKey, true, "times played, ascending"),
+		FileData::SortType(&compareTimesPlayed, &timesPlayedKey, &compareNumberKey, false, "times played, descending"),
 
-		FileData::SortType(&compareLastPlayed, true, "last played, ascending"),
-		FileData::SortType(&compareLastPlayed, false, "last played, descending")
+		FileData::SortType(&compareLastPlayed, &lastPlayedKey, &compareNumberKey, true, "last played, ascending"),
+		FileData::SortType(&compareLastPlayed, &lastPlayedKey, &compareNumberKey, false, "last played, descending")
 	};
 
 	const std::vector<FileData::SortType> SortTypes(typesArr, typesArr + sizeof(typesArr)/sizeof(typesArr[0]));
@@ -69,4 +70,58 @@ namespace FileSorts
 
 		return false;
 	}
+
+	// keys - these have to order things exactly like the compare* functions above
+
+	void fileNameKey(const FileData* file, FileData::SortKey& key)
+	{
+		const std::string& name = file->getName();
+		key.text.resize(name.length());
+		for(unsigned int i = 0; i < name.length(); i++)
+			key.text[i] = (char)toupper(name[i]);
+	}
+
+	void ratingKey(const FileData* file, FileData::SortKey& key)
+	{
+		//only games have rating metadata
+		key.valid = (file->metadata.getType() == GAME_METADATA);
+		if(key.valid)
+			key.number = file->metadata.getFloat("rating");
+	}
+
+	void timesPlayedKey(const FileData* file, FileData::SortKey& key)
+	{
+		//only games have playcount metadata
+		key.valid = (file->metadata.getType() == GAME_METADATA);
+		if(key.valid)
+			key.number = file->metadata.getInt("playcount");
+	}
+
+	void lastPlayedKey(const FileData* file, FileData::SortKey& key)
+	{
+		//only games have lastplayed metadata
+		key.valid = (file->metadata.getType() == GAME_METADATA);
+		if(!key.valid)
+			return;
+
+		//never played is not-a-date-time, which compares false against everything (just like ptime's operator<)
+		boost::posix_time::ptime time = file->metadata.getTime("lastplayed");
+		key.valid = !time.is_special();
+		if(key.valid)
+			key.number = (double)(time - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_microseconds();
+	}
+
+	bool compareTextKey(const FileData::SortKey& key1, const FileData::SortKey& key2)
+	{
+		//compare chars the same way compareFileName does (i.e. signed)
+		return std::lexicographical_compare(key1.text.begin(), key1.text.end(), key2.text.begin(), key2.text.end());
+	}
+
+	bool compareNumberKey(const FileData::SortKey& key1, const FileData::SortKey& key2)
+	{
+		if(!key1.valid || !key2.valid)
+			return false;
+
+		return key1.number < key2.number;
+	}
 };
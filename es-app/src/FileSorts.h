@@ -10,5 +10,13 @@ namespace FileSorts
 	bool compareTimesPlayed(const FileData* file1, const FileData* fil2);
 	bool compareLastPlayed(const FileData* file1, const FileData* file2);
 
+	void fileNameKey(const FileData* file, FileData::SortKey& key);
+	void ratingKey(const FileData* file, FileData::SortKey& key);
+	void timesPlayedKey(const FileData* file, FileData::SortKey& key);
+	void lastPlayedKey(const FileData* file, FileData::SortKey& key);
+
+	bool compareTextKey(const FileData::SortKey& key1, const FileData::SortKey& key2);
+	bool compareNumberKey(const FileData::SortKey& key1, const FileData::SortKey& key2);
+
 	extern const std::vector<FileData::SortType> SortTypes;
 };
@@ -1,10 +1,13 @@
 #include "Gamelist.h"
 #include "SystemData.h"
 #include "pugixml/pugixml.hpp"
+#include "XmlStreamReader.h"
 #include <boost/filesystem.hpp>
 #include "Log.h"
 #include "Settings.h"
 #include "Util.h"
+#include <unordered_map>
+#include <fstream>
 
 namespace fs = boost::filesystem;
 
@@ -26,17 +29,10 @@ FileData* findOrCreateFile(SystemData* system, const boost::filesystem::path& pa
 	bool found = false;
 	while(path_it != relative.end())
 	{
-		const std::vector<FileData*>& children = treeNode->getChildren();
-		found = false;
-		for(auto child_it = children.begin(); child_it != children.end(); child_it++)
-		{
-			if((*child_it)->getPath().filename() == *path_it)
-			{
-				treeNode = *child_it;
-				found = true;
-				break;
-			}
-		}
+		FileData* child = treeNode->findChild(path_it->string());
+		found = (child != NULL);
+		if(found)
+			treeNode = child;
 
 		// this is the end
 		if(path_it == --relative.end())
@@ -77,6 +73,47 @@ FileData* findOrCreateFile(SystemData* system, const boost::filesystem::path& pa
 	return NULL;
 }
 
+// Parses a single <game> or <folder> entry (as read by XmlStreamReader) and applies it to the system.
+// Returns false if the entry isn't valid XML.
+static bool loadFileNode(SystemData* system, std::string& text, FileType type, const fs::path& relativeTo, pugi::xml_document& doc)
+{
+	// the text is ours to mess with, so let pugixml parse it in place instead of copying it
+	pugi::xml_parse_result result = doc.load_buffer_inplace(&text[0], text.size());
+	if(!result)
+	{
+		LOG(LogError) << "Error parsing gamelist entry: " << result.description();
+		return false;
+	}
+
+	pugi::xml_node fileNode = doc.first_child();
+	fs::path path = resolvePath(fileNode.child("path").text().get(), relativeTo, false);
+	
+	if(!boost::filesystem::exists(path))
+	{
+		LOG(LogWarning) << "File \"" << path << "\" does not exist! Ignoring.";
+		return true;
+	}
+
+	FileData* file = findOrCreateFile(system, path, type);
+	if(!file)
+	{
+		LOG(LogError) << "Error finding/creating FileData for \"" << path << "\", skipping.";
+		return true;
+	}
+
+	//load the metadata
+	std::string defaultName = file->metadata.get("name");
+	file->metadata = MetaDataList::createFromXML(GAME_METADATA, fileNode, relativeTo);
+
+	//make sure name gets set if one didn't exist
+	if(file->metadata.get("name").empty())
+		file->metadata.set("name", defaultName);
+
+	//this is what's on disk, so there's nothing to write back (yet)
+	file->metadata.resetChangedFlag();
+	return true;
+}
+
 void parseGamelist(SystemData* system)
 {
 	std::string xmlpath = system->getGamelistPath(false);
@@ -86,17 +123,15 @@ void parseGamelist(SystemData* system)
 
 	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
 
-	pugi::xml_document doc;
-	pugi::xml_parse_result result = doc.load_file(xmlpath.c_str());
-
-	if(!result)
+	//read one entry at a time instead of loading the whole document - gamelists with long descriptions get big
+	XmlStreamReader reader(xmlpath);
+	if(!reader.open())
 	{
-		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << reader.getError();
 		return;
 	}
 
-	pugi::xml_node root = doc.child("gameList");
-	if(!root)
+	if(reader.getRootName() != "gameList")
 	{
 		LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
 		return;
@@ -104,37 +139,31 @@ void parseGamelist(SystemData* system)
 
 	fs::path relativeTo = system->getStartPath();
 
-	const char* tagList[2] = { "game", "folder" };
-	FileType typeList[2] = { GAME, FOLDER };
-	for(int i = 0; i < 2; i++)
+	//folders are applied after all of the games (a game can create the folder it's in), so hold on to those until the end
+	//there are usually very few of them
+	std::vector<std::string> folderNodes;
+
+	pugi::xml_document doc;
+	std::string name, text;
+	while(reader.readElement(name, text))
 	{
-		const char* tag = tagList[i];
-		FileType type = typeList[i];
-		for(pugi::xml_node fileNode = root.child(tag); fileNode; fileNode = fileNode.next_sibling(tag))
+		if(name == "game")
 		{
-			fs::path path = resolvePath(fileNode.child("path").text().get(), relativeTo, false);
-			
-			if(!boost::filesystem::exists(path))
-			{
-				LOG(LogWarning) << "File \"" << path << "\" does not exist! Ignoring.";
-				continue;
-			}
-
-			FileData* file = findOrCreateFile(system, path, type);
-			if(!file)
-			{
-				LOG(LogError) << "Error finding/creating FileData for \"" << path << "\", skipping.";
-				continue;
-			}
+			if(!loadFileNode(system, text, GAME, relativeTo, doc))
+				break;
+		}else if(name == "folder")
+		{
+			folderNodes.push_back(text);
+		}
+	}
 
-			//load the metadata
-			std::string defaultName = file->metadata.get("name");
-			file->metadata = MetaDataList::createFromXML(GAME_METADATA, fileNode, relativeTo);
+	if(reader.hasError())
+		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << reader.getError();
 
-			//make sure name gets set if one didn't exist
-			if(file->metadata.get("name").empty())
-				file->metadata.set("name", defaultName);
-		}
+	for(auto it = folderNodes.begin(); it != folderNodes.end(); it++)
+	{
+		if(!loadFileNode(system, *it, FOLDER, relativeTo, doc))
+			break;
 	}
 }
 
@@ -161,6 +190,77 @@ void addFileDataNode(pugi::xml_node& parent, const FileData* file, const char* t
 	}
 }
 
+// The files we're about to write to a gamelist, indexed by path, so the existing <game>/<folder> nodes
+// for them can be dropped as they stream past. Each file can only replace one existing node.
+class GamelistFileIndex
+{
+public:
+	GamelistFileIndex(const FileData* root, FileType type) : mBuiltCanonical(false)
+	{
+		mFiles.reserve(root->getCountRecursive(type));
+		root->visitFilesRecursive(type, [this](FileData* file) -> bool {
+			FileInfo info = { file->getPath(), false };
+			mByPath.emplace(info.path.generic_string(), mFiles.size());
+			mFiles.push_back(info);
+			return true;
+		});
+	}
+
+	// Returns true if the node with this (resolved) path is for one of our files, i.e. it'll be replaced.
+	bool take(const fs::path& nodePath)
+	{
+		auto it = mByPath.find(nodePath.generic_string());
+		if(it != mByPath.end() && !mFiles[it->second].taken)
+			return take(it->second);
+
+		// the path might be spelled differently (symlinks, "..", etc.), so fall back to comparing real paths
+		// we only pay for this when an existing entry didn't match exactly, and only once per file
+		if(!fs::exists(nodePath))
+			return false;
+
+		if(!mBuiltCanonical)
+		{
+			mBuiltCanonical = true;
+			for(size_t i = 0; i < mFiles.size(); i++)
+			{
+				boost::system::error_code ec;
+				fs::path canonical = fs::canonical(mFiles[i].path, ec);
+				if(!ec)
+					mByCanonicalPath.emplace(canonical.generic_string(), i);
+			}
+		}
+
+		boost::system::error_code ec;
+		fs::path canonical = fs::canonical(nodePath, ec);
+		if(ec)
+			return false;
+
+		it = mByCanonicalPath.find(canonical.generic_string());
+		if(it != mByCanonicalPath.end() && !mFiles[it->second].taken)
+			return take(it->second);
+
+		return false;
+	}
+
+private:
+	struct FileInfo
+	{
+		fs::path path;
+		bool taken;
+	};
+
+	bool take(size_t index)
+	{
+		mFiles[index].taken = true;
+		return true;
+	}
+
+	std::vector<FileInfo> mFiles;
+	std::unordered_map<std::string, size_t> mByPath;
+	std::unordered_map<std::string, size_t> mByCanonicalPath;
+	bool mBuiltCanonical;
+};
+
 void updateGamelist(SystemData* system)
 {
 	//We do this by reading the XML again, adding changes and then writing it back,
@@ -171,82 +271,140 @@ void updateGamelist(SystemData* system)
 	if(Settings::getInstance()->getBool("IgnoreGamelist"))
 		return;
 
+	FileData* rootFolder = system->getRootFolder();
+	if(rootFolder == nullptr)
+	{
+		LOG(LogError) << "Found no root folder for system \"" << system->getName() << "\"!";
+		return;
+	}
+
+	//nothing has changed since we read the gamelist, so what's on disk is already right
+	const bool changed = !rootFolder->visitFilesRecursive(GAME | FOLDER, [](FileData* file) -> bool {
+		return !file->metadata.wasChanged();
+	});
+	if(!changed)
+		return;
+
+	//index what we're going to write once, so existing entries can be checked against it as they're read
+	GamelistFileIndex games(rootFolder, GAME);
+	GamelistFileIndex folders(rootFolder, FOLDER);
+
+	//make sure the folders leading up to this path exist (or the write will fail)
+	boost::filesystem::path xmlWritePath(system->getGamelistPath(true));
+	boost::filesystem::create_directories(xmlWritePath.parent_path());
+
+	//the read and write paths can be the same file, so write somewhere else and move it into place once we're done
+	boost::filesystem::path xmlTempPath(xmlWritePath.generic_string() + ".tmp");
+	std::ofstream out(xmlTempPath.generic_string().c_str(), std::ios::out | std::ios::binary);
+	if(!out.is_open())
+	{
+		LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
+		return;
+	}
+
+	//pugixml writes an empty <gameList /> on one line, so only open it once there's an entry
+	out << "<?xml version=\"1.0\"?>\n";
+	bool opened = false;
+	auto printNode = [&out, &opened](const pugi::xml_node& node) {
+		if(!opened)
+		{
+			out << "<gameList>\n";
+			opened = true;
+		}
+		node.print(out, "\t", pugi::format_default, pugi::encoding_utf8, 1);
+	};
+
+	boost::system::error_code ec;
 	pugi::xml_document doc;
-	pugi::xml_node root;
 	std::string xmlReadPath = system->getGamelistPath(false);
 
 	if(boost::filesystem::exists(xmlReadPath))
 	{
-		//parse an existing file first
-		pugi::xml_parse_result result = doc.load_file(xmlReadPath.c_str());
-		
-		if(!result)
+		//copy over the existing entries one at a time, minus the ones we're about to write again
+		//anything we don't know about (unknown tags, games that aren't there anymore) is kept as-is
+		XmlStreamReader reader(xmlReadPath);
+		std::string error;
+		if(!reader.open())
 		{
-			LOG(LogError) << "Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
-			return;
-		}
-
-		root = doc.child("gameList");
-		if(!root)
+			error = reader.getError();
+		}else if(reader.getRootName() != "gameList")
 		{
 			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
+			out.close();
+			fs::remove(xmlTempPath, ec);
 			return;
 		}
-	}else{
-		//set up an empty gamelist to append to
-		root = doc.append_child("gameList");
-	}
-
 
-	//now we have all the information from the XML. now iterate through all our games and add information from there
-	FileData* rootFolder = system->getRootFolder();
-	if (rootFolder != nullptr)
-	{
-		//get only files, no folders
-		std::vector<FileData*> files = rootFolder->getFilesRecursive(GAME | FOLDER);
-		//iterate through all files, checking if they're already in the XML
-		std::vector<FileData*>::const_iterator fit = files.cbegin();
-		while(fit != files.cend())
+		std::string name, text;
+		while(error.empty() && reader.readElement(name, text))
 		{
-			const char* tag = ((*fit)->getType() == GAME) ? "game" : "folder";
+			pugi::xml_parse_result result = doc.load_buffer_inplace(&text[0], text.size());
+			if(!result)
+			{
+				error = result.description();
+				break;
+			}
 
-			// check if the file already exists in the XML
-			// if it does, remove it before adding
-			for(pugi::xml_node fileNode = root.child(tag); fileNode; fileNode = fileNode.next_sibling(tag))
+			pugi::xml_node node = doc.first_child();
+			if(name == "game" || name == "folder")
 			{
-				pugi::xml_node pathNode = fileNode.child("path");
+				pugi::xml_node pathNode = node.child("path");
 				if(!pathNode)
 				{
-					LOG(LogError) << "<" << tag << "> node contains no <path> child!";
-					continue;
-				}
-
-				fs::path nodePath = resolvePath(pathNode.text().get(), system->getStartPath(), true);
-				fs::path gamePath((*fit)->getPath());
-				if(nodePath == gamePath || (fs::exists(nodePath) && fs::exists(gamePath) && fs::equivalent(nodePath, gamePath)))
-				{
-					// found it
-					root.remove_child(fileNode);
-					break;
+					LOG(LogError) << "<" << name << "> node contains no <path> child!";
+				}else{
+					// if the file is one of ours, drop it - it's added back with the current metadata below
+					fs::path path = resolvePath(pathNode.text().get(), system->getStartPath(), true);
+					if((name == "game" ? games : folders).take(path))
+						continue;
 				}
 			}
 
-			// it was either removed or never existed to begin with; either way, we can add it now
-			addFileDataNode(root, *fit, tag, system);
-
-			++fit;
+			printNode(node);
 		}
 
-		//now write the file
+		if(error.empty())
+			error = reader.getError();
+
+		if(!error.empty())
+		{
+			LOG(LogError) << "Error parsing XML file \"" << xmlReadPath << "\"!\n	" << error;
+			out.close();
+			fs::remove(xmlTempPath, ec);
+			return;
+		}
+	}
 
-		//make sure the folders leading up to this path exist (or the write will fail)
-		boost::filesystem::path xmlWritePath(system->getGamelistPath(true));
-		boost::filesystem::create_directories(xmlWritePath.parent_path());
+	//now add all of our games, one node at a time
+	doc.reset();
+	pugi::xml_node root = doc.append_child("gameList");
+	rootFolder->visitFilesRecursive(GAME | FOLDER, [&root, &printNode, system](FileData* file) -> bool {
+		addFileDataNode(root, file, file->getType() == GAME ? "game" : "folder", system);
 
-		if (!doc.save_file(xmlWritePath.c_str())) {
-			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
+		pugi::xml_node node = root.first_child();
+		if(node)
+		{
+			printNode(node);
+			root.remove_child(node);
 		}
-	}else{
-		LOG(LogError) << "Found no root folder for system \"" << system->getName() << "\"!";
+		return true;
+	});
+
+	out << (opened ? "</gameList>\n" : "<gameList />\n");
+	out.close();
+
+	//now move the file into place
+	if(out.fail())
+	{
+		LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
+		fs::remove(xmlTempPath, ec);
+		return;
+	}
+
+	fs::rename(xmlTempPath, xmlWritePath, ec);
+	if(ec)
+	{
+		LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!\n	" << ec.message();
+		fs::remove(xmlTempPath, ec);
 	}
 }
@@ -47,11 +47,124 @@ const std::vector<MetaDataDecl>& getMDDByType(MetaDataListType type)
 
 
 MetaDataList::MetaDataList(MetaDataListType type)
-	: mType(type)
+	: mType(type), mWasChanged(true)
+{
+	// every value starts out as the (shared) default, so there's nothing to store yet
+}
+
+const std::vector<MetaDataList::Value>& MetaDataList::getDefaults(MetaDataListType type)
+{
+	struct Defaults
+	{
+		std::vector<Value> values[2];
+
+		Defaults()
+		{
+			const MetaDataListType types[2] = { GAME_METADATA, FOLDER_METADATA };
+			for(int t = 0; t < 2; t++)
+			{
+				const std::vector<MetaDataDecl>& mdd = getMDDByType(types[t]);
+				for(unsigned int i = 0; i < mdd.size(); i++)
+				{
+					Value value;
+					value.index = (unsigned char)i;
+					value.str = mdd[i].defaultValue;
+					parseValue(mdd[i].type, value);
+					values[types[t]].push_back(value);
+				}
+			}
+		}
+	};
+
+	static const Defaults defaults;
+	return defaults.values[type];
+}
+
+// string_to_ptime() sets up a locale and a stream for every call, which adds up when loading a large gamelist.
+// Times we write ourselves are always plain "YYYYMMDDTHHMMSS", so handle that here and leave anything else to string_to_ptime().
+static boost::posix_time::ptime isoStringToPtime(const std::string& str)
+{
+	if(str.size() == 15 && str[8] == 'T')
+	{
+		int fields[6] = { 0, 0, 0, 0, 0, 0 };
+		const int widths[6] = { 4, 2, 2, 2, 2, 2 };
+		bool valid = true;
+
+		const char* c = str.c_str();
+		for(int f = 0; f < 6 && valid; f++)
+		{
+			if(f == 3)
+				c++; // skip 'T'
+
+			for(int i = 0; i < widths[f]; i++, c++)
+			{
+				if(*c < '0' || *c > '9')
+				{
+					valid = false;
+					break;
+				}
+				fields[f] = fields[f] * 10 + (*c - '0');
+			}
+		}
+
+		if(valid)
+		{
+			try
+			{
+				return boost::posix_time::ptime(boost::gregorian::date(fields[0], fields[1], fields[2]),
+					boost::posix_time::time_duration(fields[3], fields[4], fields[5]));
+			}catch(std::exception&)
+			{
+				// out of range, let string_to_ptime() decide what that means
+			}
+		}
+	}
+
+	return string_to_ptime(str, "%Y%m%dT%H%M%S%F%q");
+}
+
+void MetaDataList::parseValue(MetaDataType type, Value& value)
+{
+	value.num.i = 0;
+
+	switch(type)
+	{
+	case MD_INT:
+		value.num.i = atoi(value.str.c_str());
+		break;
+	case MD_FLOAT:
+	case MD_RATING:
+		value.num.f = (float)atof(value.str.c_str());
+		break;
+	case MD_TIME:
+		value.time = isoStringToPtime(value.str);
+		break;
+	default:
+		break;
+	}
+}
+
+int MetaDataList::getIndex(const std::string& key) const
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
-	for(auto iter = mdd.begin(); iter != mdd.end(); iter++)
-		set(iter->key, iter->defaultValue);
+	for(unsigned int i = 0; i < mdd.size(); i++)
+	{
+		if(mdd[i].key == key)
+			return i;
+	}
+
+	return -1;
+}
+
+const MetaDataList::Value& MetaDataList::getValue(unsigned int index) const
+{
+	for(auto it = mValues.begin(); it != mValues.end(); it++)
+	{
+		if(it->index == index)
+			return *it;
+	}
+
+	return getDefaults(mType).at(index);
 }
 
 
@@ -84,52 +197,93 @@ void MetaDataList::appendToXML(pugi::xml_node parent, bool ignoreDefaults, const
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
 
-	for(auto mddIter = mdd.begin(); mddIter != mdd.end(); mddIter++)
+	for(unsigned int i = 0; i < mdd.size(); i++)
 	{
-		auto mapIter = mMap.find(mddIter->key);
-		if(mapIter != mMap.end())
-		{
-			// we have this value!
-			// if it's just the default (and we ignore defaults), don't write it
-			if(ignoreDefaults && mapIter->second == mddIter->defaultValue)
-				continue;
-			
-			// try and make paths relative if we can
-			std::string value = mapIter->second;
-			if(mddIter->type == MD_IMAGE_PATH)
-				value = makeRelativePath(value, relativeTo, true).generic_string();
-
-			parent.append_child(mapIter->first.c_str()).text().set(value.c_str());
-		}
+		const std::string& value = getValue(i).str;
+
+		// if it's just the default (and we ignore defaults), don't write it
+		if(ignoreDefaults && value == mdd[i].defaultValue)
+			continue;
+
+		// try and make paths relative if we can
+		if(mdd[i].type == MD_IMAGE_PATH)
+			parent.append_child(mdd[i].key.c_str()).text().set(makeRelativePath(value, relativeTo, true).generic_string().c_str());
+		else
+			parent.append_child(mdd[i].key.c_str()).text().set(value.c_str());
 	}
 }
 
 void MetaDataList::set(const std::string& key, const std::string& value)
 {
-	mMap[key] = value;
+	int index = getIndex(key);
+	if(index == -1)
+	{
+		LOG(LogError) << "Tried to set unknown metadata \"" << key << "\"!";
+		return;
+	}
+
+	mWasChanged = true;
+
+	auto it = mValues.begin();
+	while(it != mValues.end() && it->index != index)
+		it++;
+
+	// back to the default, so go back to sharing it
+	if(value == getMDD()[index].defaultValue)
+	{
+		if(it != mValues.end())
+			mValues.erase(it);
+		return;
+	}
+
+	if(it == mValues.end())
+	{
+		mValues.push_back(Value());
+		it = mValues.end() - 1;
+		it->index = (unsigned char)index;
+	}
+
+	it->str = value;
+	parseValue(getMDD()[index].type, *it);
 }
 
 void MetaDataList::setTime(const std::string& key, const boost::posix_time::ptime& time)
 {
-	mMap[key] = boost::posix_time::to_iso_string(time);
+	set(key, boost::posix_time::to_iso_string(time));
 }
 
 const std::string& MetaDataList::get(const std::string& key) const
 {
-	return mMap.at(key);
+	int index = getIndex(key);
+	if(index == -1)
+		throw std::out_of_range("unknown metadata \"" + key + "\"");
+
+	return getValue(index).str;
 }
 
 int MetaDataList::getInt(const std::string& key) const
 {
+	int index = getIndex(key);
+	if(index != -1 && getMDD()[index].type == MD_INT)
+		return getValue(index).num.i;
+
 	return atoi(get(key).c_str());
 }
 
 float MetaDataList::getFloat(const std::string& key) const
 {
+	int index = getIndex(key);
+	if(index != -1 && (getMDD()[index].type == MD_FLOAT || getMDD()[index].type == MD_RATING))
+		return getValue(index).num.f;
+
 	return (float)atof(get(key).c_str());
 }
 
 boost::posix_time::ptime MetaDataList::getTime(const std::string& key) const
 {
+	int index = getIndex(key);
+	if(index != -1 && getMDD()[index].type == MD_TIME)
+		return getValue(index).time;
+
 	return string_to_ptime(get(key), "%Y%m%dT%H%M%S%F%q");
 }
@@ -59,7 +59,32 @@ public:
 	inline MetaDataListType getType() const { return mType; }
 	inline const std::vector<MetaDataDecl>& getMDD() const { return getMDDByType(getType()); }
 
+	// true if anything has been set since the last resetChangedFlag() (used to skip rewriting unchanged gamelists)
+	inline bool wasChanged() const { return mWasChanged; }
+	inline void resetChangedFlag() { mWasChanged = false; }
+
 private:
+	// Only values that differ from their default are stored; defaults are shared by every list of the same type.
+	// MD_INT, MD_FLOAT/MD_RATING and MD_TIME values are also parsed once here, so getInt()/getFloat()/getTime() don't re-parse.
+	struct Value
+	{
+		unsigned char index; // into getMDD()
+		std::string str;
+		union
+		{
+			int i;
+			float f;
+		} num;
+		boost::posix_time::ptime time;
+	};
+
+	static const std::vector<Value>& getDefaults(MetaDataListType type);
+	static void parseValue(MetaDataType type, Value& value);
+
+	int getIndex(const std::string& key) const; // -1 if key isn't in getMDD()
+	const Value& getValue(unsigned int index) const;
+
 	MetaDataListType mType;
-	std::map<std::string, std::string> mMap;
+	std::vector<Value> mValues;
+	bool mWasChanged;
 };
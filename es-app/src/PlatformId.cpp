@@ -1,5 +1,7 @@
 #include "PlatformId.h"
 #include <string.h>
+#include <vector>
+#include <algorithm>
 
 extern const char* mameNameToRealName[];
 
@@ -86,16 +88,40 @@ namespace PlatformIds
 		return PlatformNames[id];
 	}
 
+	static bool compareMameNames(const char** a, const char** b)
+	{
+		return strcmp(*a, *b) < 0;
+	}
+
+	// mameNameToRealName isn't sorted (and has a few duplicates), so build a sorted index into it the first time we need it.
+	// stable_sort keeps duplicates in table order, so lower_bound finds the same entry the old linear search did.
+	static const std::vector<const char**>& getMameNameIndex()
+	{
+		struct MameNameIndex
+		{
+			std::vector<const char**> names;
+
+			MameNameIndex()
+			{
+				for(const char** mameNames = mameNameToRealName; *mameNames != NULL; mameNames += 2)
+					names.push_back(mameNames);
+
+				std::stable_sort(names.begin(), names.end(), compareMameNames);
+			}
+		};
+
+		static const MameNameIndex index; // thread-safe, systems are scanned in parallel
+		return index.names;
+	}
+
 	const char* getCleanMameName(const char* from)
 	{
-		const char** mameNames = mameNameToRealName;
+		const std::vector<const char**>& index = getMameNameIndex();
 
-		while(*mameNames != NULL && strcmp(from, *mameNames) != 0)
-			mameNames += 2;
+		auto it = std::lower_bound(index.begin(), index.end(), &from, compareMameNames);
+		if(it != index.end() && strcmp(**it, from) == 0)
+			return *(*it + 1);
 
-		if(*mameNames)
-			return *(mameNames + 1);
-		
 		return from;
 	}
 }
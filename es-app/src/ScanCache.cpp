@@ -0,0 +1,183 @@
+#include "ScanCache.h"
+#include "platform.h"
+#include "Log.h"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <stdint.h>
+
+namespace fs = boost::filesystem;
+
+#define SCAN_CACHE_MAGIC 0x43534345 // "ESSC"
+#define SCAN_CACHE_VERSION 1
+
+// the cache is only ever read back by the machine that wrote it, so native byte order is fine
+template <typename T>
+static void write(std::ostream& stream, T value)
+{
+	stream.write((const char*)&value, sizeof(T));
+}
+
+static void writeString(std::ostream& stream, const std::string& str)
+{
+	write<uint32_t>(stream, (uint32_t)str.size());
+	stream.write(str.data(), str.size());
+}
+
+template <typename T>
+static bool read(std::istream& stream, T& value)
+{
+	return (bool)stream.read((char*)&value, sizeof(T));
+}
+
+static bool readString(std::istream& stream, std::string& str)
+{
+	uint32_t size;
+	if(!read(stream, size))
+		return false;
+
+	str.resize(size);
+	return size == 0 || (bool)stream.read(&str[0], size);
+}
+
+ScanCache::ScanCache(const std::string& systemName, const std::string& startPath, const std::vector<std::string>& extensions)
+	: mChanged(false)
+{
+	mPath = getCacheDir() + "/" + systemName + ".cache";
+
+	mKey = startPath;
+	for(auto it = extensions.begin(); it != extensions.end(); it++)
+		mKey += "\n" + *it;
+}
+
+std::string ScanCache::getCacheDir()
+{
+	return getHomePath() + "/.emulationstation/scancache";
+}
+
+void ScanCache::clearAll()
+{
+	LOG(LogInfo) << "Deleting scan cache \"" << getCacheDir() << "\"";
+
+	boost::system::error_code ec;
+	fs::remove_all(getCacheDir(), ec);
+}
+
+void ScanCache::load()
+{
+	mLoaded.clear();
+
+	std::ifstream file(mPath.c_str(), std::ios::in | std::ios::binary);
+	if(!file)
+		return;
+
+	uint32_t magic, version;
+	std::string key;
+	if(!read(file, magic) || !read(file, version) || magic != SCAN_CACHE_MAGIC || version != SCAN_CACHE_VERSION || !readString(file, key))
+	{
+		LOG(LogWarning) << "Scan cache \"" << mPath << "\" is from another version, ignoring it";
+		return;
+	}
+
+	if(key != mKey)
+	{
+		LOG(LogInfo) << "Scan cache \"" << mPath << "\" was written for a different path or extension list, ignoring it";
+		return;
+	}
+
+	uint32_t dirCount;
+	if(!read(file, dirCount))
+		return;
+
+	for(uint32_t i = 0; i < dirCount; i++)
+	{
+		std::string path;
+		int64_t mtime;
+		uint32_t entryCount;
+		if(!readString(file, path) || !read(file, mtime) || !read(file, entryCount))
+		{
+			LOG(LogWarning) << "Scan cache \"" << mPath << "\" is truncated, ignoring it";
+			mLoaded.clear();
+			return;
+		}
+
+		Directory& dir = mLoaded[path];
+		dir.mtime = (std::time_t)mtime;
+		dir.entries.resize(entryCount);
+		for(uint32_t j = 0; j < entryCount; j++)
+		{
+			uint8_t isGame;
+			if(!readString(file, dir.entries[j].name) || !read(file, isGame))
+			{
+				LOG(LogWarning) << "Scan cache \"" << mPath << "\" is truncated, ignoring it";
+				mLoaded.clear();
+				return;
+			}
+			dir.entries[j].isGame = (isGame != 0);
+		}
+	}
+}
+
+void ScanCache::save()
+{
+	// if every directory we scanned came out of the cache, the file is already up to date
+	if(!mChanged && mScanned.size() == mLoaded.size())
+		return;
+
+	boost::system::error_code ec;
+	fs::create_directories(getCacheDir(), ec);
+
+	// write to a temporary file first so we never leave a half-written cache behind
+	const std::string tmpPath = mPath + ".tmp";
+	{
+		std::ofstream file(tmpPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if(!file)
+		{
+			LOG(LogWarning) << "Could not write scan cache \"" << tmpPath << "\"";
+			return;
+		}
+
+		write<uint32_t>(file, SCAN_CACHE_MAGIC);
+		write<uint32_t>(file, SCAN_CACHE_VERSION);
+		writeString(file, mKey);
+
+		write<uint32_t>(file, (uint32_t)mScanned.size());
+		for(auto it = mScanned.begin(); it != mScanned.end(); it++)
+		{
+			writeString(file, it->first);
+			write<int64_t>(file, (int64_t)it->second.mtime);
+			write<uint32_t>(file, (uint32_t)it->second.entries.size());
+			for(auto entry = it->second.entries.begin(); entry != it->second.entries.end(); entry++)
+			{
+				writeString(file, entry->name);
+				write<uint8_t>(file, entry->isGame ? 1 : 0);
+			}
+		}
+	}
+
+	fs::rename(tmpPath, mPath, ec);
+	if(ec)
+		LOG(LogWarning) << "Could not write scan cache \"" << mPath << "\": " << ec.message();
+}
+
+const ScanCache::Directory* ScanCache::find(const std::string& path, std::time_t mtime) const
+{
+	auto it = mLoaded.find(path);
+	if(it == mLoaded.end() || it->second.mtime != mtime)
+		return NULL;
+
+	return &it->second;
+}
+
+void ScanCache::update(const std::string& path, const Directory& dir)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if(!mChanged)
+	{
+		auto it = mLoaded.find(path);
+		if(it == mLoaded.end() || it->second.mtime != dir.mtime)
+			mChanged = true;
+	}
+
+	mScanned[path] = dir;
+}
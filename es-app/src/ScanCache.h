@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <ctime>
+
+// Remembers what populateFolder() found in each directory of a system, so directories that
+// haven't changed (same mtime) can be rebuilt without reading them again.
+// Stored in ~/.emulationstation/scancache/[system name].cache, one file per system.
+// find() and update() may be called from several scan threads at once.
+class ScanCache
+{
+public:
+	struct Entry
+	{
+		std::string name; // filename only
+		bool isGame; // false = subdirectory that needs to be scanned
+	};
+
+	struct Directory
+	{
+		std::time_t mtime;
+		std::vector<Entry> entries;
+	};
+
+	ScanCache(const std::string& systemName, const std::string& startPath, const std::vector<std::string>& extensions);
+
+	// Reads the cache file. Does nothing if it doesn't exist or was written for a different <path> or <extension>.
+	void load();
+
+	// Writes every directory passed to update() since load(), if anything changed.
+	void save();
+
+	// Returns NULL if path isn't cached or has been modified since.
+	const Directory* find(const std::string& path, std::time_t mtime) const;
+	void update(const std::string& path, const Directory& dir);
+
+	// Deletes every system's cache file (--rebuild-cache).
+	static void clearAll();
+
+private:
+	static std::string getCacheDir();
+
+	std::string mPath;
+	std::string mKey; // start path + extensions, if this doesn't match the file's we throw the file away
+
+	std::map<std::string, Directory> mLoaded; // read-only while scanning
+	std::map<std::string, Directory> mScanned;
+	bool mChanged;
+	std::mutex mMutex;
+};
@@ -27,6 +27,18 @@ int run_scraper_cmdline()
 
 	signal(SIGINT, handle_interrupt_signal);
 
+	// systems are loaded in the background, we need all of them before we can pick games
+	SystemData::waitForLoad();
+	std::vector<SystemData*> loaded = SystemData::sSystemVector;
+	for(auto it = loaded.begin(); it != loaded.end(); it++)
+	{
+		if((*it)->getRootFolder()->getChildren().size() == 0)
+		{
+			LOG(LogWarning) << "System \"" << (*it)->getName() << "\" has no games! Ignoring it.";
+			SystemData::removeSystem(*it);
+		}
+	}
+
 	//==================================================================================
 	//filter
 	//==================================================================================
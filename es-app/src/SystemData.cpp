@@ -12,13 +12,18 @@
 #include <iostream>
 #include "Settings.h"
 #include "FileSorts.h"
+#include "ThreadPool.h"
+#include "ScanCache.h"
+#include <ctime>
 
 std::vector<SystemData*> SystemData::sSystemVector;
+ThreadPool* SystemData::sLoadPool = NULL;
 
 namespace fs = boost::filesystem;
 
 SystemData::SystemData(const std::string& name, const std::string& fullName, const std::string& startPath, const std::vector<std::string>& extensions, 
 	const std::string& command, const std::vector<PlatformIds::PlatformId>& platformIds, const std::string& themeFolder)
+	: mScanCache(NULL), mPendingScanJobs(0), mLoaded(false)
 {
 	mName = name;
 	mFullName = fullName;
@@ -39,15 +44,7 @@ SystemData::SystemData(const std::string& name, const std::string& fullName, con
 	mRootFolder = new FileData(FOLDER, mStartPath, this);
 	mRootFolder->metadata.set("name", mFullName);
 
-	if(!Settings::getInstance()->getBool("ParseGamelistOnly"))
-		populateFolder(mRootFolder);
-
-	if(!Settings::getInstance()->getBool("IgnoreGamelist"))
-		parseGamelist(this);
-
-	mRootFolder->sort(FileSorts::SortTypes.at(0));
-
-	loadTheme();
+	// the folder scan and gamelist are loaded in the background by loadConfig(), so systems can be scanned in parallel
 }
 
 SystemData::~SystemData()
@@ -146,7 +143,28 @@ void SystemData::launchGame(Window* window, FileData* game)
 	game->metadata.setTime("lastplayed", time);
 }
 
-void SystemData::populateFolder(FileData* folder)
+void SystemData::queuePopulateFolder(FileData* folder, ThreadPool* pool)
+{
+	mPendingScanJobs++;
+	pool->queueWork([this, folder, pool] {
+		try
+		{
+			populateFolder(folder, pool);
+		}catch(fs::filesystem_error& e)
+		{
+			LOG(LogError) << "Error while scanning \"" << folder->getPath() << "\": " << e.what();
+		}
+
+		// last job for this system out turns off the lights
+		if(--mPendingScanJobs == 0)
+		{
+			mScanEnd = std::chrono::steady_clock::now();
+			finishLoading();
+		}
+	});
+}
+
+void SystemData::populateFolder(FileData* folder, ThreadPool* pool)
 {
 	const fs::path& folderPath = folder->getPath();
 	if(!fs::is_directory(folderPath))
@@ -168,6 +186,30 @@ void SystemData::populateFolder(FileData* folder)
 		}
 	}
 
+	// adding or removing an entry updates the directory's mtime, so if it hasn't moved we already know what's in here
+	ScanCache::Directory scanned;
+	scanned.mtime = fs::last_write_time(folderPath);
+
+	const ScanCache::Directory* cached = mScanCache->find(folderStr, scanned.mtime);
+	if(cached)
+	{
+		for(auto it = cached->entries.begin(); it != cached->entries.end(); it++)
+		{
+			FileData* newFile = new FileData(it->isGame ? GAME : FOLDER, (folderPath / it->name).generic_string(), this);
+			folder->addChild(newFile);
+			if(!it->isGame)
+				queuePopulateFolder(newFile, pool);
+		}
+
+		mScanCache->update(folderStr, *cached);
+		return;
+	}
+
+	// mtimes only have a resolution of a second (or worse) - if the directory was touched very recently,
+	// it could still change without the mtime moving, so don't let the cache trust it next time
+	if(scanned.mtime >= std::time(NULL) - 2)
+		scanned.mtime = 0;
+
 	fs::path filePath;
 	std::string extension;
 	bool isGame;
@@ -191,21 +233,64 @@ void SystemData::populateFolder(FileData* folder)
 			FileData* newGame = new FileData(GAME, filePath.generic_string(), this);
 			folder->addChild(newGame);
 			isGame = true;
+
+			ScanCache::Entry entry = { filePath.filename().string(), true };
+			scanned.entries.push_back(entry);
 		}
 
 		//add directories that also do not match an extension as folders
+		//the folder is added now so it keeps its place in the directory order, but it's scanned as its own job
+		//folders that turn out to not contain games are removed by finishLoading()
 		if(!isGame && fs::is_directory(filePath))
 		{
 			FileData* newFolder = new FileData(FOLDER, filePath.generic_string(), this);
-			populateFolder(newFolder);
+			folder->addChild(newFolder);
+			queuePopulateFolder(newFolder, pool);
 
-			//ignore folders that do not contain games
-			if(newFolder->getChildren().size() == 0)
-				delete newFolder;
-			else
-				folder->addChild(newFolder);
+			ScanCache::Entry entry = { filePath.filename().string(), false };
+			scanned.entries.push_back(entry);
 		}
 	}
+
+	mScanCache->update(folderStr, scanned);
+}
+
+//removes folders that do not contain games, deepest first (same result as checking right after each folder is scanned)
+static void removeEmptyFolders(FileData* folder)
+{
+	const std::vector<FileData*> children = folder->getChildren();
+	for(auto it = children.begin(); it != children.end(); it++)
+	{
+		if((*it)->getType() != FOLDER)
+			continue;
+
+		removeEmptyFolders(*it);
+		if((*it)->getChildren().size() == 0)
+			delete *it;
+	}
+}
+
+void SystemData::finishLoading()
+{
+	if(mScanCache)
+	{
+		mScanCache->save();
+		delete mScanCache;
+		mScanCache = NULL;
+	}
+
+	removeEmptyFolders(mRootFolder);
+
+	if(!Settings::getInstance()->getBool("IgnoreGamelist"))
+		parseGamelist(this);
+
+	mRootFolder->sort(FileSorts::SortTypes.at(0), false); // we're already running on a worker thread
+
+	LOG(LogInfo) << "System \"" << mName << "\" scanned in " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(mScanEnd - mScanStart).count() << "ms, loaded in " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mScanStart).count() << "ms";
+
+	mLoaded = true;
 }
 
 std::vector<std::string> readList(const std::string& str, const char* delims = " \t\r\n,")
@@ -260,6 +345,8 @@ bool SystemData::loadConfig()
 		return false;
 	}
 
+	std::vector<SystemData*> systems;
+
 	for(pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
 	{
 		std::string name, fullname, path, cmd, themeFolder;
@@ -312,16 +399,41 @@ bool SystemData::loadConfig()
 		boost::filesystem::path genericPath(path);
 		path = genericPath.generic_string();
 
-		SystemData* newSys = new SystemData(name, fullname, path, extensions, cmd, platformIds, themeFolder);
-		if(newSys->getRootFolder()->getChildren().size() == 0)
+		systems.push_back(new SystemData(name, fullname, path, extensions, cmd, platformIds, themeFolder));
+	}
+
+	if(Settings::getInstance()->getBool("RebuildScanCache"))
+		ScanCache::clearAll();
+
+	// themes are needed to build the carousel right away, so they're still loaded here
+	for(auto it = systems.begin(); it != systems.end(); it++)
+	{
+		(*it)->loadTheme();
+		sSystemVector.push_back(*it);
+	}
+
+	// scan every system at once in the background - on slow storage most of the time is spent waiting on the disk, not the CPU
+	// systems are queued in es_systems.cfg order, so the first ones in the carousel tend to be ready first
+	sLoadPool = new ThreadPool(Settings::getInstance()->getInt("ScanThreads"));
+	LOG(LogInfo) << "Loading " << systems.size() << " systems with " << sLoadPool->getThreadCount() << " threads...";
+
+	const bool scanFolders = !Settings::getInstance()->getBool("ParseGamelistOnly");
+	for(auto it = systems.begin(); it != systems.end(); it++)
+	{
+		SystemData* sys = *it;
+		sys->mScanStart = std::chrono::steady_clock::now();
+		sys->mScanEnd = sys->mScanStart;
+		if(scanFolders)
 		{
-			LOG(LogWarning) << "System \"" << name << "\" has no games! Ignoring it.";
-			delete newSys;
+			sys->mScanCache = new ScanCache(sys->mName, sys->mStartPath, sys->mSearchExtensions);
+			sys->mScanCache->load();
+			sys->queuePopulateFolder(sys->mRootFolder, sLoadPool);
 		}else{
-			sSystemVector.push_back(newSys);
+			sLoadPool->queueWork([sys] { sys->finishLoading(); });
 		}
 	}
 
+	// systems that turn out to have no games are removed once they're loaded (see ViewController::update())
 	return true;
 }
 
@@ -371,8 +483,31 @@ void SystemData::writeExampleConfig(const std::string& path)
 	LOG(LogError) << "Example config written!  Go read it at \"" << path << "\"!";
 }
 
+void SystemData::waitForLoad()
+{
+	if(sLoadPool)
+		sLoadPool->wait();
+}
+
+void SystemData::removeSystem(SystemData* system)
+{
+	auto it = std::find(sSystemVector.begin(), sSystemVector.end(), system);
+	if(it != sSystemVector.end())
+		sSystemVector.erase(it);
+
+	delete system;
+}
+
 void SystemData::deleteSystems()
 {
+	// worker threads could still be building a FileData tree
+	if(sLoadPool)
+	{
+		sLoadPool->wait();
+		delete sLoadPool;
+		sLoadPool = NULL;
+	}
+
 	for(unsigned int i = 0; i < sSystemVector.size(); i++)
 	{
 		delete sSystemVector.at(i);
@@ -428,7 +563,7 @@ bool SystemData::hasGamelist() const
 
 unsigned int SystemData::getGameCount() const
 {
-	return mRootFolder->getFilesRecursive(GAME).size();
+	return mRootFolder->getCountRecursive(GAME);
 }
 
 void SystemData::loadTheme()
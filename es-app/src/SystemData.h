@@ -2,12 +2,17 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
+#include <chrono>
 #include "FileData.h"
 #include "Window.h"
 #include "MetaData.h"
 #include "PlatformId.h"
 #include "ThemeData.h"
 
+class ThreadPool;
+class ScanCache;
+
 class SystemData
 {
 public:
@@ -33,10 +38,16 @@ public:
 	
 	unsigned int getGameCount() const;
 
+	// Folders are scanned and the gamelist is parsed in the background after loadConfig() returns.
+	// The FileData tree must not be touched until this is true (it never goes back to false).
+	inline bool isLoaded() const { return mLoaded; }
+
 	void launchGame(Window* window, FileData* game);
 
 	static void deleteSystems();
 	static bool loadConfig(); //Load the system config file at getConfigPath(). Returns true if no errors were encountered. An example will be written if the file doesn't exist.
+	static void waitForLoad(); // blocks until every system from loadConfig() has finished loading
+	static void removeSystem(SystemData* system); // removes system from sSystemVector and deletes it
 	static void writeExampleConfig(const std::string& path);
 	static std::string getConfigPath(bool forWrite); // if forWrite, will only return ~/.emulationstation/es_systems.cfg, never /etc/emulationstation/es_systems.cfg
 
@@ -74,7 +85,20 @@ private:
 	std::string mThemeFolder;
 	std::shared_ptr<ThemeData> mTheme;
 
-	void populateFolder(FileData* folder);
+	// Scans folder for games. Subfolders are added right away (to keep directory order) and scanned as separate jobs on pool.
+	void populateFolder(FileData* folder, ThreadPool* pool);
+	void queuePopulateFolder(FileData* folder, ThreadPool* pool);
+
+	// Called once every populateFolder job has finished. Drops empty folders, reads the gamelist, sorts and marks the system as loaded.
+	void finishLoading();
+
+	static ThreadPool* sLoadPool; // runs the background loading for every system
 
 	FileData* mRootFolder;
+
+	ScanCache* mScanCache; // only exists while loading
+	std::atomic<unsigned int> mPendingScanJobs;
+	std::chrono::steady_clock::time_point mScanStart;
+	std::chrono::steady_clock::time_point mScanEnd;
+	std::atomic<bool> mLoaded;
 };
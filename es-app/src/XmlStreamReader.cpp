@@ -0,0 +1,232 @@
+#include "XmlStreamReader.h"
+#include <string.h>
+
+XmlStreamReader::XmlStreamReader(const std::string& path) : mPath(path), mBufPos(0), mBufEnd(0), mRootClosed(false)
+{
+}
+
+bool XmlStreamReader::open()
+{
+	mFile.open(mPath.c_str(), std::ios::in | std::ios::binary);
+	if(!mFile.is_open())
+	{
+		setError("could not open file");
+		return false;
+	}
+
+	// skip the XML declaration, comments, doctype etc. until we hit the root element
+	while(true)
+	{
+		switch(readToken(NULL, &mRootName))
+		{
+		case TOKEN_START_TAG:
+			return true;
+		case TOKEN_EMPTY_TAG:
+			mRootClosed = true;
+			return true;
+		case TOKEN_END_TAG:
+			setError("unexpected end tag </" + mRootName + "> before the root element");
+			return false;
+		case TOKEN_EOF:
+			if(!hasError())
+				setError("no root element");
+			return false;
+		default:
+			break;
+		}
+	}
+}
+
+bool XmlStreamReader::readElement(std::string& name, std::string& text)
+{
+	text.clear();
+	if(mRootClosed || hasError())
+		return false;
+
+	// find the start of the next child, skipping comments and whitespace
+	TokenType type;
+	do {
+		text.clear();
+		type = readToken(&text, &name);
+	} while(type == TOKEN_OTHER);
+
+	if(type == TOKEN_END_TAG)
+	{
+		if(name != mRootName)
+			setError("expected </" + mRootName + ">, found </" + name + ">");
+
+		mRootClosed = true;
+		return false;
+	}
+
+	if(type == TOKEN_EOF)
+	{
+		if(!hasError())
+			setError("unexpected end of file, <" + mRootName + "> was never closed");
+		return false;
+	}
+
+	// drop whatever text came before the child
+	text.erase(0, text.find('<'));
+
+	if(type == TOKEN_EMPTY_TAG)
+		return true;
+
+	// read up to the matching end tag - checking that the tags actually match is left to whoever parses the text
+	std::string childName;
+	int depth = 1;
+	while(depth > 0)
+	{
+		switch(readToken(&text, &childName))
+		{
+		case TOKEN_START_TAG:
+			depth++;
+			break;
+		case TOKEN_END_TAG:
+			depth--;
+			break;
+		case TOKEN_EOF:
+			if(!hasError())
+				setError("unexpected end of file inside <" + name + ">");
+			return false;
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+XmlStreamReader::TokenType XmlStreamReader::readToken(std::string* out, std::string* tagName)
+{
+	// when we're just skipping something we still need somewhere to look for its end
+	std::string skipped;
+	std::string& token = out ? *out : skipped;
+
+	// text up to the next tag
+	while(true)
+	{
+		if(mBufPos >= mBufEnd && !fill())
+			return TOKEN_EOF;
+
+		const char* begin = mBuf + mBufPos;
+		const char* lt = (const char*)memchr(begin, '<', mBufEnd - mBufPos);
+		size_t len = lt ? (size_t)(lt - begin) : mBufEnd - mBufPos;
+		if(out)
+			token.append(begin, len);
+		mBufPos += len;
+
+		if(lt)
+			break;
+	}
+
+	token.push_back((char)get()); // '<'
+
+	int c = peek();
+	if(c == '?')
+		return readUntil("?>", &token) ? TOKEN_OTHER : TOKEN_EOF;
+
+	if(c == '!')
+	{
+		token.push_back((char)get());
+		c = peek();
+		if(c == '-')
+			return readUntil("-->", &token) ? TOKEN_OTHER : TOKEN_EOF;
+		if(c == '[')
+			return readUntil("]]>", &token) ? TOKEN_OTHER : TOKEN_EOF;
+
+		// <!DOCTYPE ...>, which can have an internal subset in brackets
+		int brackets = 0;
+		while((c = get()) != -1)
+		{
+			token.push_back((char)c);
+			if(c == '[')
+				brackets++;
+			else if(c == ']')
+				brackets--;
+			else if(c == '>' && brackets <= 0)
+				return TOKEN_OTHER;
+		}
+
+		setError("unexpected end of file inside <!");
+		return TOKEN_EOF;
+	}
+
+	const bool isEnd = (c == '/');
+	if(isEnd)
+		token.push_back((char)get());
+
+	// tag name, then attributes (which can contain '>' inside quotes)
+	tagName->clear();
+	bool inName = true;
+	char quote = 0;
+	int prev = 0;
+	while((c = get()) != -1)
+	{
+		token.push_back((char)c);
+
+		if(quote)
+		{
+			if(c == quote)
+				quote = 0;
+		}else if(c == '>')
+		{
+			if(isEnd)
+				return TOKEN_END_TAG;
+			return (prev == '/') ? TOKEN_EMPTY_TAG : TOKEN_START_TAG;
+		}else if(c == '"' || c == '\'')
+		{
+			quote = (char)c;
+		}
+
+		if(inName)
+		{
+			if(c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/' || c == '>')
+				inName = false;
+			else
+				tagName->push_back((char)c);
+		}
+
+		prev = c;
+	}
+
+	setError("unexpected end of file inside a tag");
+	return TOKEN_EOF;
+}
+
+bool XmlStreamReader::readUntil(const char* terminator, std::string* out)
+{
+	const size_t termLen = strlen(terminator);
+	const size_t start = out->size();
+
+	int c;
+	while((c = get()) != -1)
+	{
+		out->push_back((char)c);
+		if(out->size() >= start + termLen && out->compare(out->size() - termLen, termLen, terminator) == 0)
+			return true;
+	}
+
+	setError(std::string("unexpected end of file, expected \"") + terminator + "\"");
+	return false;
+}
+
+bool XmlStreamReader::fill()
+{
+	mBufPos = 0;
+	mBufEnd = 0;
+
+	if(!mFile)
+		return false;
+
+	mFile.read(mBuf, sizeof(mBuf));
+	mBufEnd = (size_t)mFile.gcount();
+	return mBufEnd > 0;
+}
+
+void XmlStreamReader::setError(const std::string& error)
+{
+	// keep the first error, it's the one that matters
+	if(mError.empty())
+		mError = error;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+
+// Reads the children of an XML document's root element one at a time, so only one child has to be in memory at once
+// (a gamelist can have tens of thousands of <game> entries, but we only ever need to look at them one by one).
+// Each child is handed back as its raw text, ready to be parsed on its own (e.g. with pugi::xml_document::load_buffer()).
+// Comments, processing instructions and text directly inside the root element are skipped.
+// This only splits the document up - entities, attributes etc. are left for whatever parses the pieces.
+class XmlStreamReader
+{
+public:
+	XmlStreamReader(const std::string& path);
+
+	// Opens the file and reads up to the root element's start tag. Returns false (see getError()) if that fails.
+	bool open();
+
+	inline const std::string& getRootName() const { return mRootName; }
+
+	// Reads the next child element of the root element into name (the tag name) and text (everything from '<' to the matching '>').
+	// Returns false once the root element is closed, or if something went wrong (see hasError()).
+	bool readElement(std::string& name, std::string& text);
+
+	inline bool hasError() const { return !mError.empty(); }
+	inline const std::string& getError() const { return mError; }
+
+private:
+	enum TokenType
+	{
+		TOKEN_START_TAG,
+		TOKEN_END_TAG,
+		TOKEN_EMPTY_TAG, // <tag/>
+		TOKEN_OTHER, // comment, CDATA, processing instruction or doctype
+		TOKEN_EOF
+	};
+
+	// Skips (or appends to out, if it's not NULL) text up to the next '<', then reads the markup starting there into out.
+	TokenType readToken(std::string* out, std::string* tagName);
+
+	bool fill();
+	inline int peek() { return (mBufPos < mBufEnd || fill()) ? (unsigned char)mBuf[mBufPos] : -1; }
+	inline int get() { return (mBufPos < mBufEnd || fill()) ? (unsigned char)mBuf[mBufPos++] : -1; }
+	bool readUntil(const char* terminator, std::string* out); // reads up to and including terminator
+
+	void setError(const std::string& error);
+
+	std::string mPath;
+	std::ifstream mFile;
+
+	char mBuf[64 * 1024];
+	size_t mBufPos;
+	size_t mBufEnd;
+
+	std::string mRootName;
+	bool mRootClosed;
+	std::string mError;
+};
@@ -33,6 +33,12 @@ void AsyncReqComponent::update(int deltaTime)
 	mTime += deltaTime;
 }
 
+bool AsyncReqComponent::isAnimating() const
+{
+	// spinning until the request is done
+	return true;
+}
+
 void AsyncReqComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = Eigen::Affine3f::Identity();
@@ -10,7 +10,7 @@ RatingComponent::RatingComponent(Window* window) : GuiComponent(window)
 	mUnfilledTexture = TextureResource::get(":/star_unfilled.svg", true);
 	mValue = 0.5f;
 	mSize << 64 * NUM_RATING_STARS, 64;
-	updateVertices();
+	onSizeChanged();
 }
 
 void RatingComponent::setValue(const std::string& value)
@@ -45,16 +45,14 @@ void RatingComponent::onSizeChanged()
 	else if(mSize.x() == 0)
 		mSize[0] = mSize.y() * NUM_RATING_STARS;
 
-	auto filledSVG = dynamic_cast<SVGResource*>(mFilledTexture.get());
-	auto unfilledSVG = dynamic_cast<SVGResource*>(mUnfilledTexture.get());
-
+	// SVG stars get rasterized at the size of one star (shared with every other rating that size)
 	if(mSize.y() > 0)
 	{
-		size_t heightPx = (size_t)round(mSize.y());
-		if(filledSVG)
-			filledSVG->rasterizeAt(heightPx, heightPx);
-		if(unfilledSVG)
-			unfilledSVG->rasterizeAt(heightPx, heightPx);
+		const int heightPx = (int)round(mSize.y());
+		if(dynamic_cast<SVGResource*>(mFilledTexture.get()))
+			mFilledTexture = TextureResource::get(mFilledTexture->getPath(), true, false, true, Eigen::Vector2i(heightPx, heightPx));
+		if(dynamic_cast<SVGResource*>(mUnfilledTexture.get()))
+			mUnfilledTexture = TextureResource::get(mUnfilledTexture->getPath(), true, false, true, Eigen::Vector2i(heightPx, heightPx));
 	}
 
 	updateVertices();
@@ -96,31 +94,14 @@ void RatingComponent::render(const Eigen::Affine3f& parentTrans)
 	Eigen::Affine3f trans = roundMatrix(parentTrans * getTransform());
 	Renderer::setMatrix(trans);
 
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	glColor4ub(255, 255, 255, getOpacity());
-
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	
-	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-	
-	mFilledTexture->bind();
-	glDrawArrays(GL_TRIANGLES, 0, 6);
-
-	mUnfilledTexture->bind();
-	glDrawArrays(GL_TRIANGLES, 6, 6);
-
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_BLEND);
+	const GLuint color = Renderer::convertColor(0xFFFFFF00 | getOpacity());
+	for(int i = 0; i < 12; i++)
+		mVertices[i].color = color;
 
-	glColor4ub(255, 255, 255, 255);
+	if(mFilledTexture->isInitialized())
+		Renderer::drawTriangles(&mVertices[0], 6, mFilledTexture->getTextureID());
+	if(mUnfilledTexture->isInitialized())
+		Renderer::drawTriangles(&mVertices[6], 6, mUnfilledTexture->getTextureID());
 
 	renderChildren(trans);
 }
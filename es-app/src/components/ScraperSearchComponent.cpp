@@ -426,6 +426,12 @@ void ScraperSearchComponent::update(int deltaTime)
 	}
 }
 
+bool ScraperSearchComponent::isAnimating() const
+{
+	// update() has to keep checking on these
+	return mBlockAccept || mSearchHandle || mMDResolveHandle || mThumbnailReq || GuiComponent::isAnimating();
+}
+
 void ScraperSearchComponent::updateThumbnail()
 {
 	if(mThumbnailReq && mThumbnailReq->status() == HttpReq::REQ_SUCCESS)
@@ -42,6 +42,7 @@ public:
 	
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
@@ -90,6 +91,7 @@ private:
 
 	int mMarqueeOffset;
 	int mMarqueeTime;
+	bool mMarqueeing; // the selected entry doesn't fit and is being scrolled across
 
 	Alignment mAlignment;
 	float mHorizontalMargin;
@@ -112,6 +114,7 @@ TextListComponent<T>::TextListComponent(Window* window) :
 {
 	mMarqueeOffset = 0;
 	mMarqueeTime = -MARQUEE_DELAY;
+	mMarqueeing = false;
 
 	mHorizontalMargin = 0;
 	mAlignment = ALIGN_CENTER;
@@ -269,6 +272,7 @@ template <typename T>
 void TextListComponent<T>::update(int deltaTime)
 {
 	listUpdate(deltaTime);
+	mMarqueeing = false;
 	if(!isScrolling() && size() > 0)
 	{
 		//if we're not scrolling and this object's text goes outside our size, marquee it!
@@ -279,6 +283,7 @@ void TextListComponent<T>::update(int deltaTime)
 		//it's long enough to marquee
 		if(textSize.x() - mMarqueeOffset > mSize.x() - 12 - (mAlignment != ALIGN_CENTER ? mHorizontalMargin : 0))
 		{
+			mMarqueeing = true;
 			mMarqueeTime += deltaTime;
 			while(mMarqueeTime > MARQUEE_SPEED)
 			{
@@ -291,6 +296,12 @@ void TextListComponent<T>::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+template <typename T>
+bool TextListComponent<T>::isAnimating() const
+{
+	return mMarqueeing || IList<TextListData, T>::isAnimating();
+}
+
 //list management stuff
 template <typename T>
 void TextListComponent<T>::add(const std::string& name, const T& obj, unsigned int color)
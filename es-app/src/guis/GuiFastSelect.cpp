@@ -110,6 +110,11 @@ void GuiFastSelect::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool GuiFastSelect::isAnimating() const
+{
+	return mScrollDir != 0 || GuiComponent::isAnimating();
+}
+
 void GuiFastSelect::scroll()
 {
 	mLetterId += mScrollDir;
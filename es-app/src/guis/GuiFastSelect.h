@@ -13,6 +13,7 @@ public:
 
 	bool input(InputConfig* config, Input input);
 	void update(int deltaTime);
+	bool isAnimating() const;
 
 private:
 	void setScrollDir(int dir);
@@ -21,12 +21,10 @@ GuiScraperStart::GuiScraperStart(Window* window) : GuiComponent(window),
 	mMenu.addWithLabel("Filter", mFilters);
 
 	//add systems (all with a platformid specified selected)
+	//we need their games, so systems still loading in the background are only added once they finish (see update())
 	mSystems = std::make_shared< OptionListComponent<SystemData*> >(mWindow, "SCRAPE THESE SYSTEMS", true);
-	for(auto it = SystemData::sSystemVector.begin(); it != SystemData::sSystemVector.end(); it++)
-	{
-		if(!(*it)->hasPlatformId(PlatformIds::PLATFORM_IGNORE))
-			mSystems->add((*it)->getFullName(), *it, !(*it)->getPlatformIds().empty());
-	}
+	mLoadingSystems = SystemData::sSystemVector;
+	addLoadedSystems();
 	mMenu.addWithLabel("Systems", mSystems);
 
 	mApproveResults = std::make_shared<SwitchComponent>(mWindow);
@@ -72,23 +70,45 @@ void GuiScraperStart::start()
 	}
 }
 
+void GuiScraperStart::addLoadedSystems()
+{
+	for(auto it = mLoadingSystems.begin(); it != mLoadingSystems.end(); )
+	{
+		SystemData* system = *it;
+		if(!system->isLoaded())
+		{
+			it++;
+			continue;
+		}
+
+		it = mLoadingSystems.erase(it);
+
+		//empty systems are about to be removed by the ViewController, so skip them
+		if(!system->hasPlatformId(PlatformIds::PLATFORM_IGNORE) && system->getRootFolder()->getChildren().size() > 0)
+		{
+			mSystems->add(system->getFullName(), system, !system->getPlatformIds().empty());
+			mWindow->invalidate();
+		}
+	}
+}
+
 std::queue<ScraperSearchParams> GuiScraperStart::getSearches(std::vector<SystemData*> systems, GameFilterFunc selector)
 {
 	std::queue<ScraperSearchParams> queue;
 	for(auto sys = systems.begin(); sys != systems.end(); sys++)
 	{
-		std::vector<FileData*> games = (*sys)->getRootFolder()->getFilesRecursive(GAME);
-		for(auto game = games.begin(); game != games.end(); game++)
-		{
-			if(selector((*sys), (*game)))
+		SystemData* system = *sys;
+		system->getRootFolder()->visitFilesRecursive(GAME, [&queue, &selector, system](FileData* game) -> bool {
+			if(selector(system, game))
 			{
 				ScraperSearchParams search;
-				search.game = *game;
-				search.system = *sys;
+				search.game = game;
+				search.system = system;
 				
 				queue.push(search);
 			}
-		}
+			return true;
+		});
 	}
 
 	return queue;
@@ -118,6 +138,20 @@ bool GuiScraperStart::input(InputConfig* config, Input input)
 	return false;
 }
 
+void GuiScraperStart::update(int deltaTime)
+{
+	//only called while we're on top, so the system popup (which holds on to mSystems' entries) can't be open
+	if(!mLoadingSystems.empty())
+		addLoadedSystems();
+
+	GuiComponent::update(deltaTime);
+}
+
+bool GuiScraperStart::hasPendingLoads() const
+{
+	return !mLoadingSystems.empty();
+}
+
 std::vector<HelpPrompt> GuiScraperStart::getHelpPrompts()
 {
 	std::vector<HelpPrompt> prompts = mMenu.getHelpPrompts();
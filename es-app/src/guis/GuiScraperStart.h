@@ -22,17 +22,22 @@ public:
 	GuiScraperStart(Window* window);
 
 	bool input(InputConfig* config, Input input) override;
+	void update(int deltaTime) override;
+	bool hasPendingLoads() const override;
 
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 
 private:
 	void pressedStart();
 	void start();
+	void addLoadedSystems();
 	std::queue<ScraperSearchParams> getSearches(std::vector<SystemData*> systems, GameFilterFunc selector);
 
 	std::shared_ptr< OptionListComponent<GameFilterFunc> > mFilters;
 	std::shared_ptr< OptionListComponent<SystemData*> > mSystems;
 	std::shared_ptr<SwitchComponent> mApproveResults;
 
+	std::vector<SystemData*> mLoadingSystems; // not in mSystems yet, added by update() as they finish
+
 	MenuComponent mMenu;
 };
@@ -17,6 +17,8 @@
 #include "EmulationStation.h"
 #include "Settings.h"
 #include "ScraperCmdLine.h"
+#include "resources/TextureResource.h"
+#include "resources/TextureDiskCache.h"
 #include <sstream>
 #include <boost/locale.hpp>
 
@@ -27,6 +29,7 @@
 namespace fs = boost::filesystem;
 
 bool scrape_cmdline = false;
+bool prewarm_cmdline = false;
 
 bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height)
 {
@@ -49,6 +52,9 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 		}else if(strcmp(argv[i], "--ignore-gamelist") == 0)
 		{
 			Settings::getInstance()->setBool("IgnoreGamelist", true);
+		}else if(strcmp(argv[i], "--rebuild-cache") == 0)
+		{
+			Settings::getInstance()->setBool("RebuildScanCache", true);
 		}else if(strcmp(argv[i], "--draw-framerate") == 0)
 		{
 			Settings::getInstance()->setBool("DrawFramerate", true);
@@ -71,6 +77,9 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 		}else if(strcmp(argv[i], "--scrape") == 0)
 		{
 			scrape_cmdline = true;
+		}else if(strcmp(argv[i], "--prewarm-cache") == 0)
+		{
+			prewarm_cmdline = true;
 		}else if(strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
 		{
 #ifdef WIN32
@@ -89,10 +98,12 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 				"--resolution [width] [height]	try and force a particular resolution\n"
 				"--gamelist-only			skip automatic game search, only read from gamelist.xml\n"
 				"--ignore-gamelist		ignore the gamelist (useful for troubleshooting)\n"
+				"--rebuild-cache			throw away the scan and texture caches and rescan everything\n"
 				"--draw-framerate		display the framerate\n"
 				"--no-exit			don't show the exit option in the menu\n"
 				"--debug				more logging, show console on Windows\n"
 				"--scrape			scrape using command line interface\n"
+				"--prewarm-cache			decode all game images into the texture cache, then quit\n"
 				"--windowed			not fullscreen, should be used with --resolution\n"
 				"--vsync [1/on or 0/off]		turn vsync on or off (default is on)\n"
 				"--help, -h			summon a sentient, angry tuba\n\n"
@@ -229,6 +240,10 @@ int main(int argc, char* argv[])
 		window.renderLoadingScreen();
 	}
 
+	//the scan cache is thrown away while loading the systems, the texture cache goes here
+	if(Settings::getInstance()->getBool("RebuildScanCache"))
+		TextureDiskCache::clear();
+
 	const char* errorMsg = NULL;
 	if(!loadSystemConfigFile(&errorMsg))
 	{
@@ -257,11 +272,26 @@ int main(int argc, char* argv[])
 		return run_scraper_cmdline();
 	}
 
+	//fill the texture cache then quit
+	if(prewarm_cmdline)
+	{
+		if(errorMsg == NULL)
+			ViewController::get()->prewarmTextureCache();
+
+		while(window.peekGui() != ViewController::get())
+			delete window.peekGui();
+		window.deinit();
+		TextureResource::shutdownLoader();
+		SystemData::deleteSystems();
+		TextureDiskCache::prune();
+		return 0;
+	}
+
 	//dont generate joystick events while we're loading (hopefully fixes "automatically started emulator" bug)
 	SDL_JoystickEventState(SDL_DISABLE);
 
-	// preload what we can right away instead of waiting for the user to select it
-	// this makes for no delays when accessing content, but a longer startup time
+	// build each system's views as soon as its games finish loading in the background, instead of waiting for the user to select it
+	// this doesn't block - systems that are still loading show up once they're done (see ViewController::update())
 	ViewController::get()->preload();
 
 	//choose which GUI to open depending on if an input configuration already exists
@@ -283,6 +313,30 @@ int main(int argc, char* argv[])
 
 	while(running)
 	{
+		// when nothing on screen is changing, wait for input instead of drawing the same frame over and over
+		const int idleTimeout = window.getIdleTimeout();
+		if(idleTimeout != 0)
+		{
+			if(idleTimeout > 0)
+				SDL_WaitEventTimeout(NULL, idleTimeout);
+			else
+				SDL_WaitEvent(NULL);
+
+			// let the time spent waiting pass before handling whatever woke us up, so anything it
+			// starts (e.g. an animation) doesn't jump ahead by however long we were waiting
+			if(!window.isSleeping())
+			{
+				int curTime = SDL_GetTicks();
+				int deltaTime = curTime - lastTime;
+				lastTime = curTime;
+
+				if(deltaTime > 1000 || deltaTime < 0)
+					deltaTime = 1000;
+
+				window.update(deltaTime);
+			}
+		}
+
 		SDL_Event event;
 		while(SDL_PollEvent(&event))
 		{
@@ -300,6 +354,10 @@ int main(int argc, char* argv[])
 				case SDL_JOYDEVICEREMOVED:
 					InputManager::getInstance()->parseEvent(event, &window);
 					break;
+				case SDL_WINDOWEVENT:
+					// e.g. the window was uncovered
+					window.invalidate();
+					break;
 				case SDL_QUIT:
 					running = false;
 					break;
@@ -308,22 +366,25 @@ int main(int argc, char* argv[])
 
 		if(window.isSleeping())
 		{
+			// nothing to update until something wakes us up (getIdleTimeout() has us waiting on input)
 			lastTime = SDL_GetTicks();
-			SDL_Delay(1); // this doesn't need to be accurate, we're just giving up our CPU time until something wakes us up
-			continue;
-		}
+		}else{
+			int curTime = SDL_GetTicks();
+			int deltaTime = curTime - lastTime;
+			lastTime = curTime;
 
-		int curTime = SDL_GetTicks();
-		int deltaTime = curTime - lastTime;
-		lastTime = curTime;
+			// cap deltaTime at 1000
+			if(deltaTime > 1000 || deltaTime < 0)
+				deltaTime = 1000;
 
-		// cap deltaTime at 1000
-		if(deltaTime > 1000 || deltaTime < 0)
-			deltaTime = 1000;
+			window.update(deltaTime);
+		}
 
-		window.update(deltaTime);
-		window.render();
-		Renderer::swapBuffers();
+		if(window.isRenderNeeded())
+		{
+			window.render();
+			Renderer::swapBuffers();
+		}
 
 		Log::flush();
 	}
@@ -332,8 +393,12 @@ int main(int argc, char* argv[])
 		delete window.peekGui();
 	window.deinit();
 
+	TextureResource::shutdownLoader();
 	SystemData::deleteSystems();
 
+	// nothing's loading textures anymore, so this is a good time to keep the texture cache in check
+	TextureDiskCache::prune();
+
 	LOG(LogInfo) << "EmulationStation cleanly shutting down.";
 
 	return 0;
@@ -43,17 +43,22 @@ void SystemView::populate()
 		// make logo
 		if(theme->getElement("system", "logo", "image"))
 		{
+			// logos are decoded/rasterized in the background (there are two for every system), so they're centered by
+			// their origin - their size isn't known until they're loaded
 			ImageComponent* logo = new ImageComponent(mWindow);
+			logo->setAsync(true);
 			logo->setMaxSize(Eigen::Vector2f(logoSize().x(), logoSize().y()));
 			logo->applyTheme((*it)->getTheme(), "system", "logo", ThemeFlags::PATH);
-			logo->setPosition((logoSize().x() - logo->getSize().x()) / 2, (logoSize().y() - logo->getSize().y()) / 2); // center
+			logo->setOrigin(0.5f, 0.5f);
+			logo->setPosition(logoSize().x() / 2, logoSize().y() / 2); // center
 			e.data.logo = std::shared_ptr<GuiComponent>(logo);
 
 			ImageComponent* logoSelected = new ImageComponent(mWindow);
+			logoSelected->setAsync(true);
 			logoSelected->setMaxSize(Eigen::Vector2f(logoSize().x() * SELECTED_SCALE, logoSize().y() * SELECTED_SCALE * 0.70f));
 			logoSelected->applyTheme((*it)->getTheme(), "system", "logo", ThemeFlags::PATH);
-			logoSelected->setPosition((logoSize().x() - logoSelected->getSize().x()) / 2, 
-				(logoSize().y() - logoSelected->getSize().y()) / 2); // center
+			logoSelected->setOrigin(0.5f, 0.5f);
+			logoSelected->setPosition(logoSize().x() / 2, logoSize().y() / 2); // center
 			e.data.logoSelected = std::shared_ptr<GuiComponent>(logoSelected);
 		}else{
 			// no logo in theme; use text
@@ -90,6 +95,25 @@ void SystemView::goToSystem(SystemData* system, bool animate)
 		finishAnimation(0);
 }
 
+void SystemView::onSystemLoaded(SystemData* system)
+{
+	if(size() > 0 && getSelected() == system)
+		updateSystemInfo();
+}
+
+void SystemView::removeSystem(SystemData* system)
+{
+	if(!remove(system) || size() == 0)
+		return;
+
+	// indices shifted, so jump straight to the (possibly new) selection
+	cancelAnimation(0);
+	mCamOffset = (float)mCursor;
+	mExtrasCamOffset = (float)mCursor;
+	mExtrasFadeOpacity = 0.0f;
+	onCursorChanged(CURSOR_STOPPED);
+}
+
 bool SystemView::input(InputConfig* config, Input input)
 {
 	if(input.value != 0)
@@ -158,44 +182,7 @@ void SystemView::onCursorChanged(const CursorState& state)
 		endPos = target - posMax; // loop around the start (max - 1 -> -1)
 
 	
-	// animate mSystemInfo's opacity (fade out, wait, fade back in)
-
-	cancelAnimation(1);
-	cancelAnimation(2);
-
-	const float infoStartOpacity = mSystemInfo.getOpacity() / 255.f;
-
-	Animation* infoFadeOut = new LambdaAnimation(
-		[infoStartOpacity, this] (float t)
-	{
-		mSystemInfo.setOpacity((unsigned char)(lerp<float>(infoStartOpacity, 0.f, t) * 255));
-	}, (int)(infoStartOpacity * 150));
-
-	unsigned int gameCount = getSelected()->getGameCount();
-
-	// also change the text after we've fully faded out
-	setAnimation(infoFadeOut, 0, [this, gameCount] {
-		std::stringstream ss;
-		
-		// only display a game count if there are at least 2 games
-		if(gameCount > 1)
-			ss << gameCount << " GAMES AVAILABLE";
-
-		mSystemInfo.setText(ss.str()); 
-	}, false, 1);
-
-	// only display a game count if there are at least 2 games
-	if(gameCount > 1)
-	{
-		Animation* infoFadeIn = new LambdaAnimation(
-			[this](float t)
-		{
-			mSystemInfo.setOpacity((unsigned char)(lerp<float>(0.f, 1.f, t) * 255));
-		}, 300);
-
-		// wait 600ms to fade in
-		setAnimation(infoFadeIn, 2000, nullptr, false, 2);
-	}
+	updateSystemInfo();
 
 	// no need to animate transition, we're not going anywhere (probably mEntries.size() == 1)
 	if(endPos == mCamOffset && endPos == mExtrasCamOffset)
@@ -249,6 +236,52 @@ void SystemView::onCursorChanged(const CursorState& state)
 	setAnimation(anim, 0, nullptr, false, 0);
 }
 
+void SystemView::updateSystemInfo()
+{
+	// animate mSystemInfo's opacity (fade out, wait, fade back in)
+
+	cancelAnimation(1);
+	cancelAnimation(2);
+
+	const float infoStartOpacity = mSystemInfo.getOpacity() / 255.f;
+
+	Animation* infoFadeOut = new LambdaAnimation(
+		[infoStartOpacity, this] (float t)
+	{
+		mSystemInfo.setOpacity((unsigned char)(lerp<float>(infoStartOpacity, 0.f, t) * 255));
+	}, (int)(infoStartOpacity * 150));
+
+	// the game list is still being built in the background, so we can't count it yet
+	const bool loaded = getSelected()->isLoaded();
+	unsigned int gameCount = loaded ? getSelected()->getGameCount() : 0;
+
+	// also change the text after we've fully faded out
+	setAnimation(infoFadeOut, 0, [this, loaded, gameCount] {
+		std::stringstream ss;
+		
+		// only display a game count if there are at least 2 games
+		if(!loaded)
+			ss << "LOADING...";
+		else if(gameCount > 1)
+			ss << gameCount << " GAMES AVAILABLE";
+
+		mSystemInfo.setText(ss.str()); 
+	}, false, 1);
+
+	// only display a game count if there are at least 2 games
+	if(!loaded || gameCount > 1)
+	{
+		Animation* infoFadeIn = new LambdaAnimation(
+			[this](float t)
+		{
+			mSystemInfo.setOpacity((unsigned char)(lerp<float>(0.f, 1.f, t) * 255));
+		}, 300);
+
+		// wait 600ms to fade in
+		setAnimation(infoFadeIn, 2000, nullptr, false, 2);
+	}
+}
+
 void SystemView::render(const Eigen::Affine3f& parentTrans)
 {
 	if(size() == 0)
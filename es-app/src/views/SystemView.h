@@ -24,6 +24,10 @@ public:
 
 	void goToSystem(SystemData* system, bool animate);
 
+	// Called by the ViewController when a system finishes loading in the background.
+	void onSystemLoaded(SystemData* system);
+	void removeSystem(SystemData* system);
+
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
 	void render(const Eigen::Affine3f& parentTrans) override;
@@ -38,6 +42,7 @@ private:
 	inline Eigen::Vector2f logoSize() const { return Eigen::Vector2f(mSize.x() * 0.25f, mSize.y() * 0.155f); }
 
 	void populate();
+	void updateSystemInfo(); // fades in the game count (or a loading message) for the selected system
 
 	TextComponent mSystemInfo;
 
@@ -11,6 +11,10 @@
 #include "animations/LaunchAnimation.h"
 #include "animations/MoveCameraAnimation.h"
 #include "animations/LambdaAnimation.h"
+#include "resources/TextureResource.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
 
 ViewController* ViewController::sInstance = NULL;
 
@@ -27,9 +31,13 @@ void ViewController::init(Window* window)
 }
 
 ViewController::ViewController(Window* window)
-	: GuiComponent(window), mCurrentView(nullptr), mCamera(Eigen::Affine3f::Identity()), mFadeOpacity(0), mLockInput(false)
+	: GuiComponent(window), mCurrentView(nullptr), mCamera(Eigen::Affine3f::Identity()), mFadeOpacity(0), mLockInput(false),
+	mPendingGameList(NULL), mBusyAnim(window)
 {
 	mState.viewing = NOTHING;
+
+	mBusyAnim.setSize(Renderer::getScreenWidth() * 0.3f, Renderer::getScreenHeight() * 0.12f);
+	mBusyAnim.setPosition((Renderer::getScreenWidth() - mBusyAnim.getSize().x()) / 2, (Renderer::getScreenHeight() - mBusyAnim.getSize().y()) / 2);
 }
 
 ViewController::~ViewController()
@@ -44,6 +52,9 @@ void ViewController::goToStart()
 	/* mState.viewing = START_SCREEN;
 	mCurrentView.reset();
 	playViewTransition(); */
+	if(SystemData::sSystemVector.empty())
+		return; // every system turned out to be empty, removeSystem() is already showing an error
+
 	goToSystemView(SystemData::sSystemVector.at(0));
 }
 
@@ -85,6 +96,19 @@ void ViewController::goToPrevGameList()
 
 void ViewController::goToGameList(SystemData* system)
 {
+	// can't build the view yet - show a busy indicator until checkLoadingSystems() sees it finish
+	if(!system->isLoaded())
+	{
+		if(mPendingGameList != system)
+			mBusyAnim.reset();
+
+		mPendingGameList = system;
+		updateHelpPrompts();
+		return;
+	}
+
+	mPendingGameList = NULL;
+
 	if(mState.viewing == SYSTEM_SELECT)
 	{
 		// move system list
@@ -208,17 +232,10 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	//if we didn't, make it, remember it, and return it
 	std::shared_ptr<IGameListView> view;
 
-	//decide type
-	bool detailed = false;
-	std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
-	for(auto it = files.begin(); it != files.end(); it++)
-	{
-		if(!(*it)->getThumbnailPath().empty())
-		{
-			detailed = true;
-			break;
-		}
-	}
+	//decide type - detailed if any file has an image (stops looking at the first one)
+	bool detailed = !system->getRootFolder()->visitFilesRecursive(GAME | FOLDER, [](FileData* file) -> bool {
+		return file->getThumbnailPath().empty();
+	});
 		
 	if(detailed)
 		view = std::shared_ptr<IGameListView>(new DetailedGameListView(mWindow, system->getRootFolder()));
@@ -258,6 +275,17 @@ bool ViewController::input(InputConfig* config, Input input)
 	if(mLockInput)
 		return true;
 
+	// waiting on a system to load, only allow backing out
+	if(mPendingGameList)
+	{
+		if(config->isMappedTo("b", input) && input.value != 0)
+		{
+			mPendingGameList = NULL;
+			updateHelpPrompts();
+		}
+		return true;
+	}
+
 	// open menu
 	if(config->isMappedTo("start", input) && input.value != 0)
 	{
@@ -274,6 +302,12 @@ bool ViewController::input(InputConfig* config, Input input)
 
 void ViewController::update(int deltaTime)
 {
+	if(!mLoadingSystems.empty())
+		checkLoadingSystems();
+
+	if(mPendingGameList)
+		mBusyAnim.update(deltaTime);
+
 	if(mCurrentView)
 	{
 		mCurrentView->update(deltaTime);
@@ -282,6 +316,27 @@ void ViewController::update(int deltaTime)
 	updateSelf(deltaTime);
 }
 
+bool ViewController::isAnimating() const
+{
+	// only the current view gets updated, so the rest can't be animating
+	if(mPendingGameList || (mCurrentView && mCurrentView->isAnimating()))
+		return true;
+
+	for(unsigned char i = 0; i < MAX_ANIMATIONS; i++)
+	{
+		if(isAnimationPlaying(i))
+			return true;
+	}
+
+	return false;
+}
+
+bool ViewController::hasPendingLoads() const
+{
+	// systems loading in the background are picked up by checkLoadingSystems() in update()
+	return !mLoadingSystems.empty();
+}
+
 void ViewController::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = mCamera * parentTrans;
@@ -305,6 +360,9 @@ void ViewController::render(const Eigen::Affine3f& parentTrans)
 				it->second->render(trans);
 	}
 
+	if(mPendingGameList)
+		mBusyAnim.render(parentTrans);
+
 	if(mWindow->peekGui() == this)
 		mWindow->renderHelpPromptsEarly();
 
@@ -316,14 +374,147 @@ void ViewController::render(const Eigen::Affine3f& parentTrans)
 	}
 }
 
-void ViewController::preload()
+void ViewController::prewarmTextureCache()
 {
+	SystemData::waitForLoad();
+
+	// views have to be built on this thread, so find out what needs doing first
+	std::vector< std::pair<std::string, Eigen::Vector2i> > images;
 	for(auto it = SystemData::sSystemVector.begin(); it != SystemData::sSystemVector.end(); it++)
 	{
-		getGameListView(*it);
+		SystemData* system = *it;
+		if(system->getRootFolder()->getChildren().size() == 0)
+			continue;
+
+		// themes decide how big images are shown, so ask the view
+		const Eigen::Vector2i maxSize = getGameListView(system)->getImageMaxSize();
+		if(maxSize.isZero())
+			continue;
+
+		system->getRootFolder()->visitFilesRecursive(GAME | FOLDER, [&](FileData* file) {
+			const std::string& image = file->metadata.get("image");
+			if(!image.empty())
+				images.push_back(std::make_pair(image, maxSize));
+			return true;
+		});
+	}
+
+	LOG(LogInfo) << "Pre-warming texture cache with " << images.size() << " images...";
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::atomic<unsigned int> failed(0);
+	ThreadPool pool;
+	for(auto it = images.begin(); it != images.end(); it++)
+	{
+		const std::pair<std::string, Eigen::Vector2i>& image = *it;
+		pool.queueWork([&image, &failed] {
+			if(!TextureResource::prewarm(image.first, image.second))
+				failed++;
+		});
+	}
+	pool.wait();
+
+	LOG(LogInfo) << "Texture cache pre-warmed in " << 
+		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() << "ms, " <<
+		failed << " images could not be decoded";
+}
+
+void ViewController::preload()
+{
+	mLoadingSystems = SystemData::sSystemVector;
+	checkLoadingSystems();
+}
+
+void ViewController::checkLoadingSystems()
+{
+	for(auto it = mLoadingSystems.begin(); it != mLoadingSystems.end(); )
+	{
+		SystemData* system = *it;
+		if(!system->isLoaded())
+		{
+			it++;
+			continue;
+		}
+
+		it = mLoadingSystems.erase(it);
+		mWindow->invalidate();
+
+		if(system->getRootFolder()->getChildren().size() == 0)
+		{
+			LOG(LogWarning) << "System \"" << system->getName() << "\" has no games! Ignoring it.";
+			removeSystem(system);
+			continue;
+		}
+
+		getGameListView(system);
+		getSystemListView()->onSystemLoaded(system);
+
+		if(mPendingGameList == system)
+			goToGameList(system);
 	}
 }
 
+void ViewController::removeSystem(SystemData* system)
+{
+	SystemData* next = (SystemData::sSystemVector.size() > 1) ? system->getNext() : NULL;
+
+	auto view = mGameListViews.find(system);
+	if(view != mGameListViews.end())
+	{
+		removeChild(view->second.get());
+		mGameListViews.erase(view);
+	}
+
+	getSystemListView()->removeSystem(system);
+	SystemData::removeSystem(system);
+
+	if(SystemData::sSystemVector.empty())
+	{
+		LOG(LogError) << "No systems found! Does at least one system have a game present? (check that extensions match!)";
+		mPendingGameList = NULL;
+		mCurrentView.reset();
+		mState.viewing = NOTHING;
+		mWindow->pushGui(new GuiMsgBox(mWindow,
+			"WE CAN'T FIND ANY SYSTEMS!\n"
+			"CHECK THAT YOUR PATHS ARE CORRECT IN THE SYSTEMS CONFIGURATION FILE, "
+			"AND YOUR GAME DIRECTORY HAS AT LEAST ONE GAME WITH THE CORRECT EXTENSION.\n\n"
+			"VISIT EMULATIONSTATION.ORG FOR MORE INFORMATION.",
+			"QUIT", [] {
+				SDL_Event ev;
+				ev.type = SDL_QUIT;
+				SDL_PushEvent(&ev);
+			}));
+		return;
+	}
+
+	// gamelists are laid out by system index, which just shifted - keep the camera on whatever it was looking at
+	float offX = mCurrentView ? mCurrentView->getPosition().x() : 0;
+	for(auto it = mGameListViews.begin(); it != mGameListViews.end(); it++)
+		it->second->setPosition(getSystemId(it->first) * (float)Renderer::getScreenWidth(), it->second->getPosition().y());
+
+	if(mState.viewing == SYSTEM_SELECT)
+		mState.system = getSystemListView()->getSelected();
+
+	if(mCurrentView)
+	{
+		offX = mCurrentView->getPosition().x() - offX;
+		mCamera.translation().x() -= offX;
+
+		// a transition that's still playing would end at the old position
+		if(offX != 0 && isAnimationPlaying(0) && !mLockInput)
+			playViewTransition();
+	}
+
+	if(mPendingGameList == system)
+		goToGameList(next);
+}
+
+void ViewController::reloadGameListView(SystemData* system, bool reloadTheme)
+{
+	if(system->isLoaded())
+		reloadGameListView(getGameListView(system).get(), reloadTheme);
+}
+
 void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
 {
 	for(auto it = mGameListViews.begin(); it != mGameListViews.end(); it++)
@@ -385,6 +576,12 @@ void ViewController::reloadAll()
 std::vector<HelpPrompt> ViewController::getHelpPrompts()
 {
 	std::vector<HelpPrompt> prompts;
+	if(mPendingGameList)
+	{
+		prompts.push_back(HelpPrompt("b", "cancel"));
+		return prompts;
+	}
+
 	if(!mCurrentView)
 		return prompts;
 	
@@ -2,6 +2,7 @@
 
 #include "views/gamelist/IGameListView.h"
 #include "views/SystemView.h"
+#include "components/BusyComponent.h"
 
 class SystemData;
 
@@ -16,14 +17,19 @@ public:
 
 	// Try to completely populate the GameListView map.
 	// Caches things so there's no pauses during transitions.
+	// Systems that are still loading in the background get their view as soon as they're done (see update()).
 	void preload();
 
 	// If a basic view detected a metadata change, it can request to recreate
 	// the current gamelist view (as it may change to be detailed).
 	void reloadGameListView(IGameListView* gamelist, bool reloadTheme = false);
-	inline void reloadGameListView(SystemData* system, bool reloadTheme = false) { reloadGameListView(getGameListView(system).get(), reloadTheme); }
+	void reloadGameListView(SystemData* system, bool reloadTheme = false); // does nothing if system is still loading
 	void reloadAll(); // Reload everything with a theme.  Used when the "ThemeSet" setting changes.
 
+	// Decodes every game image into the texture disk cache at the size its gamelist view shows it (--prewarm-cache).
+	// Waits for systems to finish loading first.
+	void prewarmTextureCache();
+
 	// Navigation.
 	void goToNextGameList();
 	void goToPrevGameList();
@@ -39,6 +45,8 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
+	bool hasPendingLoads() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 
 	enum ViewMode
@@ -74,6 +82,10 @@ private:
 
 	void playViewTransition();
 	int getSystemId(SystemData* system);
+
+	// Builds views for systems that finished loading in the background and drops the ones that turned out to be empty.
+	void checkLoadingSystems();
+	void removeSystem(SystemData* system);
 	
 	std::shared_ptr<GuiComponent> mCurrentView;
 	std::map< SystemData*, std::shared_ptr<IGameListView> > mGameListViews;
@@ -84,4 +96,8 @@ private:
 	bool mLockInput;
 
 	State mState;
+
+	std::vector<SystemData*> mLoadingSystems;
+	SystemData* mPendingGameList; // goToGameList() was called on this system before it finished loading
+	BusyComponent mBusyAnim;
 };
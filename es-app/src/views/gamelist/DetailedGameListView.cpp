@@ -1,12 +1,13 @@
 #include "views/gamelist/DetailedGameListView.h"
 #include "views/ViewController.h"
 #include "Window.h"
+#include "Settings.h"
 #include "animations/LambdaAnimation.h"
 
 DetailedGameListView::DetailedGameListView(Window* window, FileData* root) : 
 	BasicGameListView(window, root), 
 	mDescContainer(window), mDescription(window), 
-	mImage(window),
+	mImage(window), mLandedOn(NULL),
 
 	mLblRating(window), mLblReleaseDate(window), mLblDeveloper(window), mLblPublisher(window), 
 	mLblGenre(window), mLblPlayers(window), mLblLastPlayed(window), mLblPlayCount(window),
@@ -21,12 +22,14 @@ DetailedGameListView::DetailedGameListView(Window* window, FileData* root) :
 	mList.setPosition(mSize.x() * (0.50f + padding), mList.getPosition().y());
 	mList.setSize(mSize.x() * (0.50f - padding), mList.getSize().y());
 	mList.setAlignment(TextListComponent<FileData*>::ALIGN_LEFT);
-	mList.setCursorChangedCallback([&](const CursorState& state) { updateInfoPanel(); });
+	mList.setCursorChangedCallback([&](const CursorState& state) { updateInfoPanel(); prefetchImages(); });
 
 	// image
 	mImage.setOrigin(0.5f, 0.5f);
 	mImage.setPosition(mSize.x() * 0.25f, mList.getPosition().y() + mSize.y() * 0.2125f);
 	mImage.setMaxSize(mSize.x() * (0.50f - 2*padding), mSize.y() * 0.4f);
+	mImage.setAsync(true); // box art can take a while to decode, don't hold up scrolling for it
+	mImage.setPinned(false);
 	addChild(&mImage);
 
 	// metadata labels + values
@@ -189,6 +192,12 @@ void DetailedGameListView::updateInfoPanel()
 		fadingOut = true;
 	}else{
 		mImage.setImage(file->metadata.get("image"));
+		if(file != mLandedOn && !file->metadata.get("image").empty())
+		{
+			TexturePrefetcher::countLanding(!mImage.isLoading());
+			mLandedOn = file;
+		}
+
 		mDescription.setText(file->metadata.get("desc"));
 		mDescContainer.reset();
 
@@ -232,6 +241,45 @@ void DetailedGameListView::updateInfoPanel()
 	}
 }
 
+void DetailedGameListView::prefetchImages()
+{
+	// at full speed we'd never catch up, just let whatever we were decoding go
+	const int count = Settings::getInstance()->getInt("PrefetchCount");
+	if(mList.size() < 2 || count <= 0 || mList.isScrollingFast())
+	{
+		mPrefetcher.clear();
+		return;
+	}
+
+	// ahead of the cursor if we're scrolling (by however many entries we move at a time), around it if we're not
+	const int velocity = mList.getScrollVelocity();
+	std::vector<int> offsets;
+	for(int i = 1; i <= count; i++)
+	{
+		if(velocity != 0)
+		{
+			offsets.push_back(velocity * i);
+		}else{
+			offsets.push_back(i);
+			offsets.push_back(-i);
+		}
+	}
+
+	const int size = mList.size();
+	std::vector<std::string> paths;
+	for(auto it = offsets.begin(); it != offsets.end(); it++)
+	{
+		// the list wraps around
+		int index = (mList.getCursorIndex() + *it) % size;
+		if(index < 0)
+			index += size;
+
+		paths.push_back(mList.getObjectAt(index)->metadata.get("image"));
+	}
+
+	mPrefetcher.prefetch(paths, mImage.getMaxTextureSize());
+}
+
 void DetailedGameListView::launch(FileData* game)
 {
 	Eigen::Vector3f target(Renderer::getScreenWidth() / 2.0f, Renderer::getScreenHeight() / 2.0f, 0);
@@ -4,6 +4,7 @@
 #include "components/ScrollableContainer.h"
 #include "components/RatingComponent.h"
 #include "components/DateTimeComponent.h"
+#include "resources/TexturePrefetcher.h"
 
 class DetailedGameListView : public BasicGameListView
 {
@@ -14,16 +15,21 @@ public:
 
 	virtual const char* getName() const override { return "detailed"; }
 
+	virtual Eigen::Vector2i getImageMaxSize() const override { return mImage.getMaxTextureSize(); }
+
 protected:
 	virtual void launch(FileData* game) override;
 
 private:
 	void updateInfoPanel();
+	void prefetchImages();
 
 	void initMDLabels();
 	void initMDValues();
 
 	ImageComponent mImage;
+	TexturePrefetcher mPrefetcher;
+	FileData* mLandedOn; // last entry counted for the prefetch hit/miss counters
 
 	TextComponent mLblRating, mLblReleaseDate, mLblDeveloper, mLblPublisher, mLblGenre, mLblPlayers, mLblLastPlayed, mLblPlayCount;
 
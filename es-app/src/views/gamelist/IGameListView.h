@@ -35,6 +35,10 @@ public:
 
 	virtual const char* getName() const = 0;
 
+	// The size game images are scaled down to fit when this view loads them (see ImageComponent::getMaxTextureSize()),
+	// or (0, 0) if it doesn't show any or shows them at full size. Used to pre-warm the texture disk cache.
+	virtual Eigen::Vector2i getImageMaxSize() const { return Eigen::Vector2i::Zero(); }
+
 	virtual HelpStyle getHelpStyle() override;
 protected:
 	FileData* mRoot;
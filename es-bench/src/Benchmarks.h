@@ -0,0 +1,10 @@
+#pragma once
+
+// Each benchmark prints its own results to stdout. They're standalone on purpose: they time the old and new version of an
+// algorithm side by side on synthetic data, so they don't need a window, a GL context or a ROM collection to run.
+
+// FileData lookups done by findOrCreateFile() while parsing a gamelist, on 50k-entry flat and nested trees.
+void benchGamelistLookup();
+
+// Font::wrapText() before and after it was made single-pass, on descriptions of 1-16 paragraphs.
+void benchTextWrap();
@@ -0,0 +1,172 @@
+#include "Benchmarks.h"
+#include "Util.h"
+#include <boost/filesystem.hpp>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+namespace fs = boost::filesystem;
+
+// the old linear search is quadratic in folder size (~10 minutes for a flat 50k folder), so it only looks up every
+// LINEAR_SAMPLE_STEP-th entry and the time is scaled up - entries are spread evenly through their folders, so that's unbiased
+#define LINEAR_SAMPLE_STEP 10
+
+namespace
+{
+	// Just the parts of FileData that findOrCreateFile() touches: the path, the children and (new) the filename index.
+	struct BenchFile
+	{
+		BenchFile(const fs::path& path, bool indexed) : path(path), indexed(indexed) {}
+		~BenchFile()
+		{
+			for(auto it = children.begin(); it != children.end(); it++)
+				delete *it;
+		}
+
+		void addChild(BenchFile* file)
+		{
+			children.push_back(file);
+			if(indexed)
+				childrenByFilename.emplace(file->path.filename().string(), file);
+		}
+
+		fs::path path;
+		bool indexed;
+		std::vector<BenchFile*> children;
+		std::unordered_map<std::string, BenchFile*> childrenByFilename;
+	};
+
+	// The tree walk from findOrCreateFile() (es-app/src/Gamelist.cpp), for an entry that's already been scanned:
+	// before, each path component was found by comparing it against every child's filename...
+	BenchFile* findLinear(BenchFile* root, const fs::path& relative)
+	{
+		BenchFile* node = root;
+		for(auto path_it = relative.begin(); path_it != relative.end() && node; path_it++)
+		{
+			BenchFile* found = NULL;
+			for(auto child_it = node->children.begin(); child_it != node->children.end(); child_it++)
+			{
+				if((*child_it)->path.filename() == *path_it)
+				{
+					found = *child_it;
+					break;
+				}
+			}
+			node = found;
+		}
+		return node;
+	}
+
+	// ...now it's FileData::findChild(), a lookup in the folder's filename index
+	BenchFile* findIndexed(BenchFile* root, const fs::path& relative)
+	{
+		BenchFile* node = root;
+		for(auto path_it = relative.begin(); path_it != relative.end() && node; path_it++)
+		{
+			auto it = node->childrenByFilename.find(path_it->string());
+			node = (it != node->childrenByFilename.end()) ? it->second : NULL;
+		}
+		return node;
+	}
+
+	// Builds the tree the way the folder scan does, so every gamelist entry matches a FileData that already exists.
+	void populate(BenchFile* folder)
+	{
+		for(fs::directory_iterator it(folder->path), end; it != end; ++it)
+		{
+			BenchFile* file = new BenchFile(it->path(), folder->indexed);
+			folder->addChild(file);
+			if(fs::is_directory(it->path()))
+				populate(file);
+		}
+	}
+
+	double timeLookups(const fs::path& rootPath, const std::vector<fs::path>& entries, bool indexed, bool resolve)
+	{
+		BenchFile root(rootPath, indexed);
+		populate(&root);
+
+		// parseGamelist() makes every path relative to the system with removeCommonPath() first - either time that
+		// along with the walk, or do it up front to see the walk on its own
+		const size_t step = indexed ? 1 : LINEAR_SAMPLE_STEP;
+		std::vector<fs::path> relative;
+		if(!resolve)
+		{
+			for(size_t i = 0; i < entries.size(); i += step)
+			{
+				bool contains;
+				relative.push_back(removeCommonPath(entries[i], rootPath, contains));
+			}
+		}
+
+		size_t misses = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for(size_t i = 0, n = 0; i < entries.size(); i += step, n++)
+		{
+			fs::path rel;
+			if(resolve)
+			{
+				bool contains;
+				rel = removeCommonPath(entries[i], rootPath, contains);
+			}
+
+			const fs::path& path = resolve ? rel : relative[n];
+			if(!(indexed ? findIndexed(&root, path) : findLinear(&root, path)))
+				misses++;
+		}
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		if(misses)
+			std::cerr << "  " << misses << " entries weren't found!\n";
+
+		return ms * step;
+	}
+
+	void createFile(const fs::path& path, std::vector<fs::path>& entries)
+	{
+		std::ofstream(path.string().c_str());
+		entries.push_back(path);
+	}
+}
+
+void benchGamelistLookup()
+{
+	const fs::path base = fs::temp_directory_path() / fs::unique_path("es-bench-%%%%-%%%%");
+
+	// flat: 50k games in one folder
+	std::vector<fs::path> flat;
+	fs::create_directories(base / "flat");
+	for(int i = 0; i < 50000; i++)
+		createFile(base / "flat" / ("Game " + std::to_string(i) + " (USA).zip"), flat);
+
+	// nested: 50 folders of 20 subfolders of 50 games
+	std::vector<fs::path> nested;
+	for(int a = 0; a < 50; a++)
+	{
+		for(int b = 0; b < 20; b++)
+		{
+			const fs::path dir = base / "nested" / ("Collection " + std::to_string(a)) / ("Disc " + std::to_string(b));
+			fs::create_directories(dir);
+			for(int i = 0; i < 50; i++)
+				createFile(dir / ("Game " + std::to_string(i) + ".zip"), nested);
+		}
+	}
+
+	std::cout << std::fixed << std::setprecision(1);
+	for(int resolve = 0; resolve < 2; resolve++)
+	{
+		std::cout << (resolve ? "with removeCommonPath(), as parseGamelist() does it:\n" : "tree walk only:\n");
+		std::cout << "  flat   50k: linear " << std::setw(10) << timeLookups(base / "flat", flat, false, resolve != 0) << " ms"
+			<< "   indexed " << std::setw(8) << timeLookups(base / "flat", flat, true, resolve != 0) << " ms\n";
+		std::cout << "  nested 50k: linear " << std::setw(10) << timeLookups(base / "nested", nested, false, resolve != 0) << " ms"
+			<< "   indexed " << std::setw(8) << timeLookups(base / "nested", nested, true, resolve != 0) << " ms\n";
+	}
+	std::cout << "(linear times are from every " << LINEAR_SAMPLE_STEP << "th entry, scaled up)\n";
+
+	boost::system::error_code ec;
+	fs::remove_all(base, ec);
+}
@@ -0,0 +1,164 @@
+#include "Benchmarks.h"
+#include <map>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+namespace
+{
+	// Stands in for Font's glyphs: a made-up advance per character, looked up the same way for both versions.
+	// '\n' is 0 wide, like it's drawn (the old sizeText() counted its glyph, the new one doesn't).
+	struct Advances
+	{
+		float get(unsigned char c)
+		{
+			if(c == '\n')
+				return 0.0f;
+
+			auto it = map.find(c);
+			if(it == map.end())
+				it = map.insert(std::make_pair(c, 6.0f + (c % 7))).first;
+			return it->second;
+		}
+
+		std::map<unsigned char, float> map;
+	};
+
+	float sizeText(Advances& advances, const std::string& text)
+	{
+		float lineWidth = 0.0f;
+		float highestWidth = 0.0f;
+		for(size_t i = 0; i < text.length(); i++)
+		{
+			if(text[i] == '\n')
+			{
+				if(lineWidth > highestWidth)
+					highestWidth = lineWidth;
+				lineWidth = 0.0f;
+			}
+			lineWidth += advances.get(text[i]);
+		}
+		return lineWidth > highestWidth ? lineWidth : highestWidth;
+	}
+
+	// Font::wrapText() before: erase a word off the front, measure the whole line so far again
+	std::string wrapOld(Advances& advances, std::string text, float xLen)
+	{
+		std::string out;
+		std::string line, word, temp;
+		while(text.length() > 0)
+		{
+			size_t space = text.find_first_of(" \t\n");
+			if(space == std::string::npos)
+				space = text.length() - 1;
+
+			word = text.substr(0, space + 1);
+			text.erase(0, space + 1);
+
+			temp = line + word;
+			if(sizeText(advances, temp) <= xLen)
+			{
+				line = temp;
+				continue;
+			}else{
+				out += line + '\n';
+				line = word;
+			}
+		}
+		out += line;
+		return out;
+	}
+
+	// Font::getWrapInfo() + wrapText() now: one pass adding up word widths and recording where the breaks go
+	std::string wrapNew(Advances& advances, const std::string& text, float xLen)
+	{
+		std::vector<size_t> breaks;
+		float lineWidth = 0.0f;
+		float wordWidth = 0.0f;
+		size_t lineStart = 0;
+		size_t wordStart = 0;
+
+		for(size_t i = 0; i < text.length(); )
+		{
+			const unsigned char c = text[i++];
+			wordWidth += advances.get(c);
+
+			if(c != ' ' && c != '\t' && c != '\n' && i != text.length())
+				continue;
+
+			if(lineWidth + wordWidth > xLen && wordStart != lineStart)
+			{
+				breaks.push_back(wordStart);
+				lineWidth = 0.0f;
+				lineStart = wordStart;
+			}
+
+			lineWidth += wordWidth;
+			wordWidth = 0.0f;
+			wordStart = i;
+
+			if(c == '\n')
+			{
+				lineWidth = 0.0f;
+				lineStart = i;
+			}
+		}
+
+		std::string out;
+		out.reserve(text.length() + breaks.size());
+		size_t start = 0;
+		for(auto it = breaks.begin(); it != breaks.end(); it++)
+		{
+			out.append(text, start, *it - start);
+			out += '\n';
+			start = *it;
+		}
+		out.append(text, start, std::string::npos);
+		return out;
+	}
+
+	template<typename Func>
+	double timePerCall(unsigned int iterations, Func func)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for(unsigned int i = 0; i < iterations; i++)
+			func();
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+	}
+}
+
+void benchTextWrap()
+{
+	// about the size of a typical scraped <desc>
+	const std::string paragraph = "Mario must rescue Princess Toadstool from the evil Bowser, king of the Koopas, who has taken over the "
+		"Mushroom Kingdom. Run and jump through eight worlds of side-scrolling action, collecting coins and power-ups along the way. ";
+
+	Advances advances;
+	const unsigned int iterations = 200;
+	const int paragraphCounts[] = { 1, 4, 16 };
+	const float widths[] = { 600.0f, 1200.0f };
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "  chars   width        old        new   (per wrap)\n";
+	for(int p = 0; p < 3; p++)
+	{
+		std::string desc;
+		for(int i = 0; i < paragraphCounts[p]; i++)
+			desc += paragraph + paragraph + paragraph + "\n\n";
+
+		for(int w = 0; w < 2; w++)
+		{
+			const float xLen = widths[w];
+			const double oldTime = timePerCall(iterations, [&] { wrapOld(advances, desc, xLen); });
+			const double newTime = timePerCall(iterations, [&] { wrapNew(advances, desc, xLen); });
+
+			std::cout << "  " << std::setw(5) << desc.length() << "  " << std::setw(4) << (int)xLen << "px  "
+				<< std::setw(7) << oldTime << " us " << std::setw(7) << newTime << " us";
+			if(wrapOld(advances, desc, xLen) != wrapNew(advances, desc, xLen))
+				std::cout << "   (output differs!)";
+			std::cout << "\n";
+		}
+	}
+}
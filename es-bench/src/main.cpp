@@ -0,0 +1,50 @@
+#include "Benchmarks.h"
+#include <iostream>
+#include <string.h>
+
+struct Benchmark
+{
+	const char* name;
+	void (*run)();
+};
+
+static const Benchmark benchmarks[] = {
+	{ "gamelist", &benchGamelistLookup },
+	{ "wrap", &benchTextWrap },
+};
+
+int main(int argc, char* argv[])
+{
+	const size_t count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+	// no arguments runs everything
+	bool ranAny = false;
+	for(size_t i = 0; i < count; i++)
+	{
+		bool wanted = (argc < 2);
+		for(int arg = 1; arg < argc; arg++)
+		{
+			if(strcmp(argv[arg], benchmarks[i].name) == 0)
+				wanted = true;
+		}
+
+		if(!wanted)
+			continue;
+
+		std::cout << "== " << benchmarks[i].name << " ==\n";
+		benchmarks[i].run();
+		std::cout << "\n";
+		ranAny = true;
+	}
+
+	if(!ranAny)
+	{
+		std::cerr << "Usage: es-bench [benchmark...]\nBenchmarks:";
+		for(size_t i = 0; i < count; i++)
+			std::cerr << " " << benchmarks[i].name;
+		std::cerr << "\n";
+		return 1;
+	}
+
+	return 0;
+}
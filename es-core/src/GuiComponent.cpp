@@ -56,6 +56,23 @@ void GuiComponent::update(int deltaTime)
 	updateChildren(deltaTime);
 }
 
+bool GuiComponent::isAnimating() const
+{
+	for(unsigned char i = 0; i < MAX_ANIMATIONS; i++)
+	{
+		if(isAnimationPlaying(i))
+			return true;
+	}
+
+	for(unsigned int i = 0; i < getChildCount(); i++)
+	{
+		if(getChild(i)->isAnimating())
+			return true;
+	}
+
+	return false;
+}
+
 void GuiComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = parentTrans * getTransform();
@@ -28,6 +28,15 @@ public:
 	//Called when time passes.  Default implementation calls updateSelf(deltaTime) and updateChildren(deltaTime) - so you should probably call GuiComponent::update(deltaTime) at some point (or at least updateSelf so animations work).
 	virtual void update(int deltaTime);
 
+	//Returns true if the next update() could change how this component (or one of its children) looks without any input - an animation
+	//is playing, a list is scrolling, etc.  While the top GUI isn't animating, Window stops drawing frames and the main loop waits for input.
+	//Default implementation checks the animation slots and the children.  Override this if your update() moves things along on its own.
+	virtual bool isAnimating() const;
+
+	//Returns true while update() is waiting on something finishing in the background (e.g. a gamelist loading).  Unlike isAnimating(),
+	//nothing is drawn for it - Window just keeps calling update() every so often so it notices, and update() calls Window::invalidate() once it does.
+	virtual bool hasPendingLoads() const { return false; }
+
 	//Called when it's time to render.  By default, just calls renderChildren(parentTrans * getTransform()).
 	//You probably want to override this like so:
 	//1. Calculate the new transform that your control will draw at with Eigen::Affine3f t = parentTrans * getTransform().
@@ -1,11 +1,18 @@
 #include "ImageIO.h"
 
 #include <memory.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 #include "Log.h"
 
 
-std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height)
+std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, size_t maxWidth, size_t maxHeight)
 {
 	std::vector<unsigned char> rawData;
 	width = 0;
@@ -17,7 +24,12 @@ std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * d
 		if (format != FIF_UNKNOWN && FreeImage_FIFSupportsReading(format))
 		{
 			//file type is supported. load image
-			FIBITMAP * fiBitmap = FreeImage_LoadFromMemory(format, fiMemory);
+			//JPEGs can be decoded at a fraction of their size (DCT scaling), as long as the longest side stays >= (size << 16).
+			//the result will fit in the longest side of the box we want, so asking for that is always enough.
+			int flags = 0;
+			if (format == FIF_JPEG && maxWidth > 0 && maxHeight > 0)
+				flags = (int)(maxWidth > maxHeight ? maxWidth : maxHeight) << 16;
+			FIBITMAP * fiBitmap = FreeImage_LoadFromMemory(format, fiMemory, flags);
 			if (fiBitmap != nullptr)
 			{
 				//loaded. convert to 32bit if necessary
@@ -32,34 +44,40 @@ std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * d
 						fiBitmap = fiConverted;
 					}
 				}
+				//scale down to fit in maxWidth x maxHeight
+				if (fiBitmap != nullptr && (maxWidth > 0 || maxHeight > 0))
+				{
+					const size_t srcWidth = FreeImage_GetWidth(fiBitmap);
+					const size_t srcHeight = FreeImage_GetHeight(fiBitmap);
+					double scale = 1.0;
+					if (maxWidth > 0 && srcWidth > maxWidth)
+						scale = (double)maxWidth / srcWidth;
+					if (maxHeight > 0 && srcHeight * scale > maxHeight)
+						scale = (double)maxHeight / srcHeight;
+
+					if (scale < 1.0)
+					{
+						const int scaledWidth = (int)(srcWidth * scale + 0.5) > 0 ? (int)(srcWidth * scale + 0.5) : 1;
+						const int scaledHeight = (int)(srcHeight * scale + 0.5) > 0 ? (int)(srcHeight * scale + 0.5) : 1;
+						FIBITMAP * fiScaled = FreeImage_Rescale(fiBitmap, scaledWidth, scaledHeight, FILTER_BILINEAR);
+						if (fiScaled != nullptr)
+						{
+							FreeImage_Unload(fiBitmap);
+							fiBitmap = fiScaled;
+						}
+					}
+				}
 				if (fiBitmap != nullptr)
 				{
 					width = FreeImage_GetWidth(fiBitmap);
 					height = FreeImage_GetHeight(fiBitmap);
 					unsigned int pitch = FreeImage_GetPitch(fiBitmap);
-					//loop through scanlines and add all pixel data to the return vector
-					//this is necessary, because width*height*bpp might not be == pitch
-					unsigned char * tempData = new unsigned char[width * height * 4];
-					for (size_t i = 0; i < height; i++)
-					{
-						const BYTE * scanLine = FreeImage_GetScanLine(fiBitmap, i);
-						memcpy(tempData + (i * width * 4), scanLine, width * 4);
-					}
-					//convert from BGRA to RGBA
-					for(size_t i = 0; i < width*height; i++)
-					{
-						RGBQUAD bgra = ((RGBQUAD *)tempData)[i];
-						RGBQUAD rgba;
-						rgba.rgbBlue = bgra.rgbRed;
-						rgba.rgbGreen = bgra.rgbGreen;
-						rgba.rgbRed = bgra.rgbBlue;
-						rgba.rgbReserved = bgra.rgbReserved;
-						((RGBQUAD *)tempData)[i] = rgba;
-					}
-					rawData = std::vector<unsigned char>(tempData, tempData + width * height * 4);
+					//copy the scanlines straight into the return vector, converting from BGRA to RGBA on the way
+					//(scanlines are pitch bytes apart, which might not be == width*bpp)
+					rawData.resize(width * height * 4);
+					copyPixels(rawData.data(), FreeImage_GetBits(fiBitmap), width, height, pitch, true, false);
 					//free bitmap data
 					FreeImage_Unload(fiBitmap);
-					delete[] tempData;
 				}
 			}
 			else
@@ -77,17 +95,69 @@ std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char * d
 	return rawData;
 }
 
+// swaps bytes 0 and 2 of count 4-byte pixels
+static void swapRedBlue(unsigned char* dst, const unsigned char* src, size_t count)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	// no byte shuffle in SSE2, but swapping the low and high 16 bits of (pixel & 0x00FF00FF) does the same thing
+	const __m128i maskRB = _mm_set1_epi32(0x00FF00FF);
+	const __m128i maskGA = _mm_set1_epi32((int)0xFF00FF00);
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m128i px = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		const __m128i rb = _mm_and_si128(px, maskRB);
+		const __m128i swapped = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(_mm_and_si128(px, maskGA), swapped));
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for(; i + 16 <= count; i += 16)
+	{
+		uint8x16x4_t px = vld4q_u8(src + i * 4);
+		const uint8x16_t tmp = px.val[0];
+		px.val[0] = px.val[2];
+		px.val[2] = tmp;
+		vst4q_u8(dst + i * 4, px);
+	}
+#endif
+
+	for(; i < count; i++)
+	{
+		const unsigned char b = src[i * 4];
+		dst[i * 4] = src[i * 4 + 2];
+		dst[i * 4 + 1] = src[i * 4 + 1];
+		dst[i * 4 + 2] = b;
+		dst[i * 4 + 3] = src[i * 4 + 3];
+	}
+}
+
+void ImageIO::copyPixels(unsigned char* dst, const unsigned char* src, size_t width, size_t height, size_t srcPitch, bool swapRB, bool flipVert)
+{
+	const size_t rowSize = width * 4;
+	for(size_t y = 0; y < height; y++)
+	{
+		const unsigned char* srcRow = src + (flipVert ? (height - 1 - y) : y) * srcPitch;
+		unsigned char* dstRow = dst + y * rowSize;
+
+		if(swapRB)
+			swapRedBlue(dstRow, srcRow, width);
+		else
+			memcpy(dstRow, srcRow, rowSize);
+	}
+}
+
 void ImageIO::flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height)
 {
-	unsigned int temp;
-	unsigned int* arr = (unsigned int*)imagePx;
+	// swap whole rows, top and bottom working towards the middle
+	const size_t rowSize = width * 4;
+	std::vector<unsigned char> temp(rowSize);
 	for(size_t y = 0; y < height / 2; y++)
 	{
-		for(size_t x = 0; x < width; x++)
-		{
-			temp = arr[x + (y * width)];
-			arr[x + (y * width)] = arr[x + (height * width) - ((y + 1) * width)];
-			arr[x + (height * width) - ((y + 1) * width)] = temp;
-		}
+		unsigned char* top = imagePx + y * rowSize;
+		unsigned char* bottom = imagePx + (height - 1 - y) * rowSize;
+		memcpy(temp.data(), top, rowSize);
+		memcpy(top, bottom, rowSize);
+		memcpy(bottom, temp.data(), rowSize);
 	}
 }
@@ -6,6 +6,13 @@
 class ImageIO
 {
 public:
-	static std::vector<unsigned char> loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height);
+	// If maxWidth and/or maxHeight are set, images bigger than that are scaled down (keeping their aspect ratio) to fit.
+	static std::vector<unsigned char> loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, size_t maxWidth = 0, size_t maxHeight = 0);
+
+	// Copies height rows of width 32-bit pixels from src (rows srcPitch bytes apart) to dst (rows packed together), in one pass.
+	// Swaps the first and third channel (BGRA <-> RGBA) if swapRB is set, and reverses the order of the rows if flipVert is set.
+	// Uses SSE2/NEON where available.
+	static void copyPixels(unsigned char* dst, const unsigned char* src, size_t width, size_t height, size_t srcPitch, bool swapRB, bool flipVert);
+
 	static void flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height);
 };
\ No newline at end of file
@@ -21,14 +21,63 @@ namespace Renderer
 	unsigned int getScreenWidth();
 	unsigned int getScreenHeight();
 
-	void buildGLColorArray(GLubyte* ptr, unsigned int color, unsigned int vertCount);
+	GLuint convertColor(unsigned int color); // 0xRRGGBBAA to what goes in Vertex::color
+
+	struct Vertex
+	{
+		Eigen::Vector2f pos;
+		Eigen::Vector2f tex;
+		GLuint color; // see convertColor()
+	};
 
 	//graphics commands
 	void swapBuffers();
 
+	// Everything is drawn through these. Vertices are transformed by the current matrix (see setMatrix()) on the CPU and
+	// collected into one stream, which is only actually drawn when the texture, blending, primitive type or clipping
+	// changes (or at the end of the frame), so a screen full of images and text takes a handful of draw calls.
+	// A texture of 0 draws untextured. Only the 2D part of the matrix is used.
+	void drawTriangles(const Vertex* vertices, unsigned int count, GLuint texture = 0, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+	void drawLines(const Vertex* vertices, unsigned int count);
+
+	// Draws whatever has been collected so far. Only needed before using GL directly.
+	void flush();
+
+	// Geometry that gets drawn the same way frame after frame (e.g. a big block of text) can be uploaded once instead of going
+	// through the batch every frame. drawBuffer() draws it with the current matrix, but as a draw call of its own (it flushes
+	// the batch first), so it's only worth it for lots of vertices. Buffers are lost when the renderer is deinitialized -
+	// isBufferValid() goes false and uploadBuffer() makes a new one. uploadBuffer() returns false if buffer objects aren't
+	// supported, use drawTriangles() then.
+	struct VertexBuffer
+	{
+		GLuint id;
+		unsigned int count;
+		unsigned int generation; // buffers from before the last deinit() are gone
+
+		VertexBuffer() : id(0), count(0), generation(0) {}
+	};
+
+	bool uploadBuffer(VertexBuffer& buffer, const Vertex* vertices, unsigned int count);
+	bool isBufferValid(const VertexBuffer& buffer);
+	void drawBuffer(const VertexBuffer& buffer, GLuint texture);
+	void deleteBuffer(VertexBuffer& buffer);
+
+	// Number of draw calls the last frame took.
+	unsigned int getDrawCalls();
+
+	// Used by init(), deinit() and swapBuffers() (Renderer_init_*.cpp).
+	void initBatch();
+	void deinitBatch();
+	void endFrame();
+
 	void pushClipRect(Eigen::Vector2i pos, Eigen::Vector2i dim);
 	void popClipRect();
 
+	// Binds texture to GL_TEXTURE_2D, skipping the GL call if it's already bound.
+	// Every texture bind and delete has to go through these for that to work.
+	void bindTexture(GLuint texture);
+	void deleteTexture(GLuint texture);
+
 	void setMatrix(float* mat);
 	void setMatrix(const Eigen::Affine3f& transform);
 
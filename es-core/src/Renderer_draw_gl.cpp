@@ -8,8 +8,265 @@
 #include <stack>
 #include "Util.h"
 
+#ifdef USE_OPENGL_DESKTOP
+	#include <SDL.h>
+#endif
+
 namespace Renderer {
 	std::stack<Eigen::Vector4i> clipStack;
+	GLuint boundTexture = 0;
+
+#ifdef USE_OPENGL_ES
+	// buffer objects are part of OpenGL ES 1.1
+	static decltype(&glGenBuffers) genBuffers = &glGenBuffers;
+	static decltype(&glBindBuffer) bindBuffer = &glBindBuffer;
+	static decltype(&glBufferData) bufferData = &glBufferData;
+	static decltype(&glDeleteBuffers) deleteBuffers = &glDeleteBuffers;
+
+	static void loadBufferFunctions()
+	{
+	}
+#else
+	// buffer objects are only core since OpenGL 1.5, and not every platform exports them (e.g. Windows), so look them up
+	static PFNGLGENBUFFERSPROC genBuffers = NULL;
+	static PFNGLBINDBUFFERPROC bindBuffer = NULL;
+	static PFNGLBUFFERDATAPROC bufferData = NULL;
+	static PFNGLDELETEBUFFERSPROC deleteBuffers = NULL;
+
+	static void loadBufferFunctions()
+	{
+		genBuffers = (PFNGLGENBUFFERSPROC)SDL_GL_GetProcAddress("glGenBuffers");
+		bindBuffer = (PFNGLBINDBUFFERPROC)SDL_GL_GetProcAddress("glBindBuffer");
+		bufferData = (PFNGLBUFFERDATAPROC)SDL_GL_GetProcAddress("glBufferData");
+		deleteBuffers = (PFNGLDELETEBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteBuffers");
+	}
+#endif
+
+	// the batch drawTriangles()/drawLines() collect into
+	Eigen::Affine3f currentMatrix = Eigen::Affine3f::Identity();
+	std::vector<Vertex> batchVertices;
+	GLenum batchMode = GL_TRIANGLES;
+	GLuint batchTexture = 0;
+	GLenum batchBlendSrc = GL_SRC_ALPHA;
+	GLenum batchBlendDst = GL_ONE_MINUS_SRC_ALPHA;
+
+	GLuint whiteTexture = 0; // untextured things are drawn with this, so they don't break up the batch
+	GLuint streamBuffer = 0; // 0 if buffer objects aren't supported, then the batch is drawn straight from memory
+	unsigned int contextGeneration = 0; // bumped by deinitBatch(), VertexBuffers from before that are gone
+
+	unsigned int drawCalls = 0;
+	unsigned int lastFrameDrawCalls = 0;
+
+	void bindTexture(GLuint texture)
+	{
+		if(texture == boundTexture)
+			return;
+
+		glBindTexture(GL_TEXTURE_2D, texture);
+		boundTexture = texture;
+	}
+
+	void deleteTexture(GLuint texture)
+	{
+		// something waiting to be drawn might still use it
+		if(texture == batchTexture)
+			flush();
+
+		// GL unbinds it for us, and the name can be handed out again by glGenTextures()
+		if(texture == boundTexture)
+			boundTexture = 0;
+
+		glDeleteTextures(1, &texture);
+	}
+
+	void initBatch()
+	{
+		loadBufferFunctions();
+		if(genBuffers && bindBuffer && bufferData && deleteBuffers)
+		{
+			genBuffers(1, &streamBuffer);
+			bindBuffer(GL_ARRAY_BUFFER, streamBuffer);
+		}else{
+			LOG(LogWarning) << "Vertex buffer objects aren't supported, drawing from client memory";
+		}
+
+		const GLubyte white[4] = { 255, 255, 255, 255 };
+		glGenTextures(1, &whiteTexture);
+		bindTexture(whiteTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		// this is all the state anything is ever drawn with, so it's only set once. the modelview matrix stays
+		// the identity, since vertices are transformed before they go in the batch.
+		glEnable(GL_TEXTURE_2D);
+		glEnable(GL_BLEND);
+		glBlendFunc(batchBlendSrc, batchBlendDst);
+
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+
+		glLoadIdentity();
+	}
+
+	void deinitBatch()
+	{
+		batchVertices.clear();
+
+		if(streamBuffer)
+		{
+			deleteBuffers(1, &streamBuffer);
+			streamBuffer = 0;
+		}
+
+		deleteTexture(whiteTexture);
+		whiteTexture = 0;
+
+		// the context is going away, the next one starts out with nothing bound (or uploaded)
+		boundTexture = 0;
+		batchTexture = 0;
+		contextGeneration++;
+	}
+
+	void flush()
+	{
+		if(batchVertices.empty())
+			return;
+
+		bindTexture(batchTexture);
+		glBlendFunc(batchBlendSrc, batchBlendDst);
+
+		const GLubyte* base = NULL;
+		if(streamBuffer)
+		{
+			// the whole buffer is replaced every time, so the driver can hand us fresh memory instead of waiting on the GPU
+			bufferData(GL_ARRAY_BUFFER, batchVertices.size() * sizeof(Vertex), batchVertices.data(), GL_STREAM_DRAW);
+		}else{
+			base = (const GLubyte*)batchVertices.data();
+		}
+
+		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), base);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + sizeof(Eigen::Vector2f));
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), base + sizeof(Eigen::Vector2f) * 2);
+
+		glDrawArrays(batchMode, 0, batchVertices.size());
+		drawCalls++;
+
+		batchVertices.clear();
+	}
+
+	static void addToBatch(GLenum mode, const Vertex* vertices, unsigned int count, GLuint texture, GLenum blend_sfactor, GLenum blend_dfactor)
+	{
+		if(count == 0)
+			return;
+
+		if(texture == 0)
+			texture = whiteTexture;
+
+		if(mode != batchMode || texture != batchTexture || blend_sfactor != batchBlendSrc || blend_dfactor != batchBlendDst)
+		{
+			flush();
+			batchMode = mode;
+			batchTexture = texture;
+			batchBlendSrc = blend_sfactor;
+			batchBlendDst = blend_dfactor;
+		}
+
+		const Eigen::Matrix2f linear = currentMatrix.linear().topLeftCorner<2, 2>();
+		const Eigen::Vector2f translation = currentMatrix.translation().head<2>();
+
+		const size_t start = batchVertices.size();
+		batchVertices.resize(start + count);
+		for(unsigned int i = 0; i < count; i++)
+		{
+			Vertex& vert = batchVertices[start + i];
+			vert.pos = linear * vertices[i].pos + translation;
+			vert.tex = vertices[i].tex;
+			vert.color = vertices[i].color;
+		}
+	}
+
+	void drawTriangles(const Vertex* vertices, unsigned int count, GLuint texture, GLenum blend_sfactor, GLenum blend_dfactor)
+	{
+		addToBatch(GL_TRIANGLES, vertices, count, texture, blend_sfactor, blend_dfactor);
+	}
+
+	void drawLines(const Vertex* vertices, unsigned int count)
+	{
+		addToBatch(GL_LINES, vertices, count, 0, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	bool isBufferValid(const VertexBuffer& buffer)
+	{
+		return buffer.id != 0 && buffer.generation == contextGeneration;
+	}
+
+	bool uploadBuffer(VertexBuffer& buffer, const Vertex* vertices, unsigned int count)
+	{
+		if(!streamBuffer)
+			return false;
+
+		if(!isBufferValid(buffer))
+		{
+			genBuffers(1, &buffer.id);
+			buffer.generation = contextGeneration;
+		}
+
+		bindBuffer(GL_ARRAY_BUFFER, buffer.id);
+		bufferData(GL_ARRAY_BUFFER, count * sizeof(Vertex), vertices, GL_STATIC_DRAW);
+		bindBuffer(GL_ARRAY_BUFFER, streamBuffer);
+
+		buffer.count = count;
+		return true;
+	}
+
+	void drawBuffer(const VertexBuffer& buffer, GLuint texture)
+	{
+		if(!isBufferValid(buffer) || buffer.count == 0)
+			return;
+
+		flush();
+
+		bindTexture(texture != 0 ? texture : whiteTexture);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		// these vertices weren't transformed on the way in, so GL does it
+		glLoadMatrixf(currentMatrix.data());
+
+		bindBuffer(GL_ARRAY_BUFFER, buffer.id);
+		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), NULL);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), (const GLubyte*)NULL + sizeof(Eigen::Vector2f));
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), (const GLubyte*)NULL + sizeof(Eigen::Vector2f) * 2);
+
+		glDrawArrays(GL_TRIANGLES, 0, buffer.count);
+		drawCalls++;
+
+		bindBuffer(GL_ARRAY_BUFFER, streamBuffer);
+		glLoadIdentity();
+	}
+
+	void deleteBuffer(VertexBuffer& buffer)
+	{
+		// one from an old context went with it
+		if(isBufferValid(buffer))
+			deleteBuffers(1, &buffer.id);
+
+		buffer.id = 0;
+		buffer.count = 0;
+	}
+
+	void endFrame()
+	{
+		flush();
+		lastFrameDrawCalls = drawCalls;
+		drawCalls = 0;
+	}
+
+	unsigned int getDrawCalls()
+	{
+		return lastFrameDrawCalls;
+	}
 
 	void setColor4bArray(GLubyte* array, unsigned int color)
 	{
@@ -19,14 +276,11 @@ namespace Renderer {
 		array[3] = (color & 0x000000ff);
 	}
 
-	void buildGLColorArray(GLubyte* ptr, unsigned int color, unsigned int vertCount)
+	GLuint convertColor(unsigned int color)
 	{
-		unsigned int colorGl;
+		GLuint colorGl;
 		setColor4bArray((GLubyte*)&colorGl, color);
-		for(unsigned int i = 0; i < vertCount; i++)
-		{
-			((GLuint*)ptr)[i] = colorGl;
-		}
+		return colorGl;
 	}
 
 	void pushClipRect(Eigen::Vector2i pos, Eigen::Vector2i dim)
@@ -62,6 +316,7 @@ namespace Renderer {
 		if(box[3] < 0)
 			box[3] = 0;
 
+		flush();
 		clipStack.push(box);
 		glScissor(box[0], box[1], box[2], box[3]);
 		glEnable(GL_SCISSOR_TEST);
@@ -75,6 +330,7 @@ namespace Renderer {
 			return;
 		}
 
+		flush();
 		clipStack.pop();
 		if(clipStack.empty())
 		{
@@ -92,49 +348,33 @@ namespace Renderer {
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor, GLenum blend_dfactor)
 	{
-#ifdef USE_OPENGL_ES
-		GLshort points[12];
-#else
-		GLint points[12];
-#endif
+		const GLuint colorGl = convertColor(color);
 
-		points[0] = x; points [1] = y;
-		points[2] = x; points[3] = y + h;
-		points[4] = x + w; points[5] = y;
+		Vertex verts[6];
+		verts[0].pos << (float)x, (float)y;
+		verts[1].pos << (float)x, (float)(y + h);
+		verts[2].pos << (float)(x + w), (float)y;
 
-		points[6] = x + w; points[7] = y;
-		points[8] = x; points[9] = y + h;
-		points[10] = x + w; points[11] = y + h;
+		verts[3].pos << (float)(x + w), (float)y;
+		verts[4].pos << (float)x, (float)(y + h);
+		verts[5].pos << (float)(x + w), (float)(y + h);
 
-		GLubyte colors[6*4];
-		buildGLColorArray(colors, color, 6);
-
-		glEnable(GL_BLEND);
-		glBlendFunc(blend_sfactor, blend_dfactor);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-#ifdef USE_OPENGL_ES
-		glVertexPointer(2, GL_SHORT, 0, points);
-#else
-		glVertexPointer(2, GL_INT, 0, points);
-#endif
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
-
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		for(int i = 0; i < 6; i++)
+		{
+			verts[i].tex << 0, 0;
+			verts[i].color = colorGl;
+		}
 
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		drawTriangles(verts, 6, 0, blend_sfactor, blend_dfactor);
 	}
 
 	void setMatrix(float* matrix)
 	{
-		glLoadMatrixf(matrix);
+		currentMatrix.matrix() = Eigen::Map<Eigen::Matrix4f>(matrix);
 	}
 
 	void setMatrix(const Eigen::Affine3f& matrix)
 	{
-		setMatrix((float*)matrix.data());
+		currentMatrix = matrix;
 	}
 };
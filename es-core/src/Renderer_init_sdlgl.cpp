@@ -116,6 +116,7 @@ namespace Renderer
 
 	void swapBuffers()
 	{
+		endFrame();
 		SDL_GL_SwapWindow(sdlWindow);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
@@ -153,11 +154,14 @@ namespace Renderer
 		glMatrixMode(GL_MODELVIEW);
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
+		initBatch();
+
 		return true;
 	}
 
 	void deinit()
 	{
+		deinitBatch();
 		destroySurface();
 	}
 };
@@ -18,7 +18,8 @@ std::vector<const char*> settings_dont_save = boost::assign::list_of
 	("Windowed")
 	("VSync")
 	("HideConsole")
-	("IgnoreGamelist");
+	("IgnoreGamelist")
+	("RebuildScanCache");
 
 Settings::Settings()
 {
@@ -57,6 +58,7 @@ void Settings::setDefaults()
 	mBoolMap["ShowHelpPrompts"] = true;
 	mBoolMap["ScrapeRatings"] = true;
 	mBoolMap["IgnoreGamelist"] = false;
+	mBoolMap["RebuildScanCache"] = false;
 	mBoolMap["HideConsole"] = true;
 	mBoolMap["QuickSystemSelect"] = true;
 
@@ -67,6 +69,10 @@ void Settings::setDefaults()
 	mIntMap["ScreenSaverTime"] = 5*60*1000; // 5 minutes
 	mIntMap["ScraperResizeWidth"] = 400;
 	mIntMap["ScraperResizeHeight"] = 0;
+	mIntMap["ScanThreads"] = 0; // 0 = one per hardware thread
+	mIntMap["MaxVRAM"] = 80; // in megabytes, see TextureResource::get()
+	mIntMap["PrefetchCount"] = 4; // how many entries ahead of the cursor to decode images for
+	mIntMap["TextureCacheSize"] = 512; // in megabytes, 0 = no limit - see TextureDiskCache::prune()
 
 	mStringMap["TransitionStyle"] = "fade";
 	mStringMap["ThemeSet"] = "";
@@ -0,0 +1,75 @@
+#include "ThreadPool.h"
+#include "Log.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount) : mRunning(0), mStopping(false)
+{
+	if(threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if(threadCount == 0) // hardware_concurrency() is allowed to not know
+		threadCount = 1;
+
+	for(unsigned int i = 0; i < threadCount; i++)
+		mThreads.push_back(std::thread(&ThreadPool::run, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mWorkAvailable.notify_all();
+
+	for(auto it = mThreads.begin(); it != mThreads.end(); it++)
+		it->join();
+}
+
+void ThreadPool::queueWork(Work work)
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mWorkQueue.push_back(work);
+	}
+	mWorkAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mWorkDone.wait(lock, [this] { return mWorkQueue.empty() && mRunning == 0; });
+}
+
+void ThreadPool::run()
+{
+	while(true)
+	{
+		Work work;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWorkAvailable.wait(lock, [this] { return mStopping || !mWorkQueue.empty(); });
+
+			if(mWorkQueue.empty()) // stopping and nothing left to do
+				return;
+
+			work = mWorkQueue.front();
+			mWorkQueue.pop_front();
+			mRunning++;
+		}
+
+		try
+		{
+			work();
+		}catch(std::exception& e)
+		{
+			LOG(LogError) << "Unhandled exception in worker thread: " << e.what();
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mRunning--;
+			if(mRunning == 0 && mWorkQueue.empty())
+				mWorkDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+// A fixed-size pool of worker threads that pull jobs from a shared queue.
+// Jobs may queue more jobs (e.g. one per subdirectory) - wait() returns once the queue
+// is empty and no job is still running.
+class ThreadPool
+{
+public:
+	typedef std::function<void()> Work;
+
+	// threadCount of 0 means "one per hardware thread".
+	ThreadPool(unsigned int threadCount = 0);
+	~ThreadPool();
+
+	void queueWork(Work work);
+
+	// Blocks until every queued job (including jobs queued by other jobs) has finished.
+	void wait();
+
+	inline unsigned int getThreadCount() const { return (unsigned int)mThreads.size(); }
+
+private:
+	void run();
+
+	std::vector<std::thread> mThreads;
+	std::deque<Work> mWorkQueue;
+
+	std::mutex mMutex;
+	std::condition_variable mWorkAvailable;
+	std::condition_variable mWorkDone;
+
+	unsigned int mRunning;
+	bool mStopping;
+};
@@ -7,8 +7,16 @@
 #include <iomanip>
 #include "components/HelpComponent.h"
 #include "components/ImageComponent.h"
+#include "resources/TexturePrefetcher.h"
 
-Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10), 
+// while nothing is happening the main loop still updates this often (in ms), for timers like DateTimeComponent's
+#define IDLE_UPDATE_TIME 500
+
+// how often to check for finished background texture loads while waiting on them (in ms)
+#define PENDING_LOAD_POLL_TIME 10
+
+Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mRenderCountElapsed(0), 
+	mAnimatingTimeElapsed(0), mAnimatingCountElapsed(0), mAverageDeltaTime(10), mRenderNeeded(true), mAnimating(false), 
 	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0)
 {
 	mHelp = new HelpComponent(this);
@@ -31,6 +39,7 @@ void Window::pushGui(GuiComponent* gui)
 {
 	mGuiStack.push_back(gui);
 	gui->updateHelpPrompts();
+	mRenderNeeded = true;
 }
 
 void Window::removeGui(GuiComponent* gui)
@@ -40,6 +49,7 @@ void Window::removeGui(GuiComponent* gui)
 		if(*i == gui)
 		{
 			i = mGuiStack.erase(i);
+			mRenderNeeded = true;
 
 			if(i == mGuiStack.end() && mGuiStack.size()) // we just popped the stack and the stack is not empty
 				mGuiStack.back()->updateHelpPrompts();
@@ -83,24 +93,30 @@ bool Window::init(unsigned int width, unsigned int height)
 	if(peekGui())
 		peekGui()->updateHelpPrompts();
 
+	mRenderNeeded = true;
 	return true;
 }
 
 void Window::deinit()
 {
 	InputManager::getInstance()->deinit();
+	TextureResource::clearCache();
 	ResourceManager::getInstance()->unloadAll();
 	Renderer::deinit();
 }
 
 void Window::textInput(const char* text)
 {
+	mRenderNeeded = true;
+
 	if(peekGui())
 		peekGui()->textInput(text);
 }
 
 void Window::input(InputConfig* config, Input input)
 {
+	mRenderNeeded = true;
+
 	if(mSleeping)
 	{
 		// wake up
@@ -140,9 +156,16 @@ void Window::update(int deltaTime)
 
 	mFrameTimeElapsed += deltaTime;
 	mFrameCountElapsed++;
+	if(mAnimating)
+	{
+		mAnimatingTimeElapsed += deltaTime;
+		mAnimatingCountElapsed++;
+	}
+
 	if(mFrameTimeElapsed > 500)
 	{
-		mAverageDeltaTime = mFrameTimeElapsed / mFrameCountElapsed;
+		if(mAnimatingCountElapsed > 0)
+			mAverageDeltaTime = mAnimatingTimeElapsed / mAnimatingCountElapsed;
 		
 		if(Settings::getInstance()->getBool("DrawFramerate"))
 		{
@@ -152,29 +175,62 @@ void Window::update(int deltaTime)
 			ss << std::fixed << std::setprecision(1) << (1000.0f * (float)mFrameCountElapsed / (float)mFrameTimeElapsed) << "fps, ";
 			ss << std::fixed << std::setprecision(2) << ((float)mFrameTimeElapsed / (float)mFrameCountElapsed) << "ms";
 
+			// frames that were actually drawn (see isRenderNeeded())
+			ss << "\nRendered: " << mRenderCountElapsed << " of " << mFrameCountElapsed << " frames";
+
 			// vram
 			float textureVramUsageMb = TextureResource::getTotalMemUsage() / 1000.0f / 1000.0f;;
 			float fontVramUsageMb = Font::getTotalMemUsage() / 1000.0f / 1000.0f;;
 			float totalVramUsageMb = textureVramUsageMb + fontVramUsageMb;
 			ss << "\nVRAM: " << totalVramUsageMb << "mb (texs: " << textureVramUsageMb << "mb, fonts: " << fontVramUsageMb << "mb)";
 
+			// image prefetching
+			ss << "\nPrefetch: " << TexturePrefetcher::getHits() << " hits, " << TexturePrefetcher::getMisses() << " misses";
+
+			// batching (see Renderer::drawTriangles())
+			ss << "\nDraw calls: " << Renderer::getDrawCalls() << " per frame";
+
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(1)->buildTextCache(ss.str(), 50.f, 50.f, 0xFF00FFFF));
+			mRenderNeeded = true;
 		}
 
 		mFrameTimeElapsed = 0;
 		mFrameCountElapsed = 0;
+		mRenderCountElapsed = 0;
+		mAnimatingTimeElapsed = 0;
+		mAnimatingCountElapsed = 0;
 	}
 
 	mTimeSinceLastInput += deltaTime;
 
+	// textures that were decoded in the background since last frame
+	if(TextureResource::uploadLoadedTextures())
+		mRenderNeeded = true;
+
 	if(peekGui())
 		peekGui()->update(deltaTime);
+
+	// keep drawing until whatever was moving has stopped (only the top GUI gets updated, so only it can be animating)
+	const bool wasAnimating = mAnimating;
+	mAnimating = peekGui() && peekGui()->isAnimating();
+	if(mAnimating || wasAnimating)
+		mRenderNeeded = true;
+
+	unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
+	if(!mSleeping && mTimeSinceLastInput >= screensaverTime && screensaverTime != 0 && mAllowSleep)
+	{
+		// go to sleep
+		mSleeping = true;
+		onSleep();
+	}
 }
 
 void Window::render()
 {
 	Eigen::Affine3f transform = Eigen::Affine3f::Identity();
 
+	mRenderNeeded = false;
+	mRenderCountElapsed++;
 	mRenderedHelpPrompts = false;
 
 	// draw only bottom and top of GuiStack (if they are different)
@@ -200,12 +256,12 @@ void Window::render()
 		mDefaultFonts.at(1)->renderTextCache(mFrameDataText.get());
 	}
 
-	unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
-	if(mTimeSinceLastInput >= screensaverTime && screensaverTime != 0 && mAllowSleep)
+	if(mSleeping)
 	{
-		// go to sleep
-		mSleeping = true;
-		onSleep();
+		// nothing gets drawn while we're asleep, so this stays up until something wakes us
+		Renderer::setMatrix(Eigen::Affine3f::Identity());
+		unsigned char opacity = Settings::getInstance()->getString("ScreenSaverBehavior") == "dim" ? 0xA0 : 0xFF;
+		Renderer::drawRect(0, 0, Renderer::getScreenWidth(), Renderer::getScreenHeight(), 0x00000000 | opacity);
 	}
 }
 
@@ -214,6 +270,41 @@ void Window::normalizeNextUpdate()
 	mNormalizeNextUpdate = true;
 }
 
+void Window::invalidate()
+{
+	mRenderNeeded = true;
+}
+
+int Window::getIdleTimeout() const
+{
+	if(mRenderNeeded)
+		return 0;
+
+	if(mSleeping)
+		return -1;
+
+	if(mAnimating)
+		return 0;
+
+	// finished loads should be drawn as soon as they're in
+	if(TextureResource::hasPendingLoads() || (!mGuiStack.empty() && mGuiStack.back()->hasPendingLoads()))
+		return PENDING_LOAD_POLL_TIME;
+
+	// don't wait past when the screensaver should kick in
+	int timeout = IDLE_UPDATE_TIME;
+	unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
+	if(screensaverTime != 0 && mAllowSleep)
+	{
+		if(mTimeSinceLastInput >= screensaverTime)
+			return 0;
+
+		if(screensaverTime - mTimeSinceLastInput < (unsigned int)timeout)
+			timeout = (int)(screensaverTime - mTimeSinceLastInput);
+	}
+
+	return timeout;
+}
+
 bool Window::getAllowSleep()
 {
 	return mAllowSleep;
@@ -325,9 +416,8 @@ void Window::setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpSt
 
 void Window::onSleep()
 {
-	Renderer::setMatrix(Eigen::Affine3f::Identity());
-	unsigned char opacity = Settings::getInstance()->getString("ScreenSaverBehavior") == "dim" ? 0xA0 : 0xFF;
-	Renderer::drawRect(0, 0, Renderer::getScreenWidth(), Renderer::getScreenHeight(), 0x00000000 | opacity);
+	// draw the screensaver (see render())
+	mRenderNeeded = true;
 }
 
 void Window::onWake()
@@ -23,6 +23,15 @@ public:
 	void update(int deltaTime);
 	void render();
 
+	// Frames are only drawn when something changed: input, a GUI being pushed/removed, a texture finishing loading,
+	// or the top GUI animating (see GuiComponent::isAnimating()). If render() isn't needed, neither is swapping buffers.
+	inline bool isRenderNeeded() const { return mRenderNeeded; }
+	void invalidate(); // something on screen changed outside of input or an animation, draw another frame
+
+	// How long (in ms) the main loop can wait for input before it needs to call update() again.
+	// 0 means don't wait (there's a frame to draw), -1 means there's nothing to do until there's input.
+	int getIdleTimeout() const;
+
 	bool init(unsigned int width = 0, unsigned int height = 0);
 	void deinit();
 
@@ -50,12 +59,18 @@ private:
 
 	int mFrameTimeElapsed;
 	int mFrameCountElapsed;
+	int mRenderCountElapsed;
+	int mAnimatingTimeElapsed; // mAverageDeltaTime only counts frames that followed an animating one, not time spent waiting
+	int mAnimatingCountElapsed;
 	int mAverageDeltaTime;
 
 	std::unique_ptr<TextCache> mFrameDataText;
 
 	bool mNormalizeNextUpdate;
 
+	bool mRenderNeeded;
+	bool mAnimating; // the top GUI as of the last update
+
 	bool mAllowSleep;
 	bool mSleeping;
 	unsigned int mTimeSinceLastInput;
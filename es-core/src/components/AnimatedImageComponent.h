@@ -24,6 +24,7 @@ public:
 	void reset(); // set to frame 0
 
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& trans) override;
 
 	void onSizeChanged() override;
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "GuiComponent.h"
 #include "components/ComponentGrid.h"
 #include "components/NinePatchComponent.h"
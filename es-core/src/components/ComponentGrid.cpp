@@ -194,8 +194,14 @@ void ComponentGrid::updateSeparators()
 		}
 	}
 
-	mLineColors.reserve(mLines.size());
-	Renderer::buildGLColorArray((GLubyte*)mLineColors.data(), 0xC6C7C6FF, mLines.size());
+	const GLuint color = Renderer::convertColor(0xC6C7C6FF);
+	mLineVertices.resize(mLines.size());
+	for(unsigned int i = 0; i < mLines.size(); i++)
+	{
+		mLineVertices[i].pos << mLines[i].x, mLines[i].y;
+		mLineVertices[i].tex << 0, 0;
+		mLineVertices[i].color = color;
+	}
 }
 
 void ComponentGrid::onSizeChanged()
@@ -362,23 +368,10 @@ void ComponentGrid::render(const Eigen::Affine3f& parentTrans)
 	renderChildren(trans);
 	
 	// draw cell separators
-	if(mLines.size())
+	if(mLineVertices.size())
 	{
 		Renderer::setMatrix(trans);
-
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, 0, &mLines[0].x);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mLineColors.data());
-
-		glDrawArrays(GL_LINES, 0, mLines.size());
-
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		Renderer::drawLines(mLineVertices.data(), mLineVertices.size());
 	}
 }
 
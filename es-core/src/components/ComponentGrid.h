@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GuiComponent.h"
+#include "Renderer.h"
 
 namespace GridFlags
 {
@@ -101,7 +102,7 @@ private:
 	};
 
 	std::vector<Vert> mLines;
-	std::vector<unsigned int> mLineColors;
+	std::vector<Renderer::Vertex> mLineVertices; // what's actually drawn, mLines with colors
 
 	// Update position & size
 	void updateCellComponent(const GridEntry& cell);
@@ -128,6 +128,7 @@ void DateTimeComponent::update(int deltaTime)
 		{
 			mRelativeUpdateAccumulator = 0;
 			updateTextCache();
+			mWindow->invalidate();
 		}
 	}
 
@@ -99,6 +99,20 @@ public:
 		return (mScrollVelocity != 0 && mScrollTier > 0);
 	}
 
+	// true once we've been scrolling long enough to hit the last (fastest) scroll tier
+	bool isScrollingFast() const
+	{
+		return isScrolling() && mScrollTier >= mTierList.count - 1;
+	}
+
+	inline int getScrollVelocity() const { return mScrollVelocity; }
+
+	// scrolling, or the title overlay is still fading
+	bool isAnimating() const override
+	{
+		return mScrollVelocity != 0 || mTitleOverlayOpacity != 0 || GuiComponent::isAnimating();
+	}
+
 	void stopScrolling()
 	{
 		listInput(0);
@@ -170,6 +184,9 @@ public:
 
 	inline int size() const { return mEntries.size(); }
 
+	inline int getCursorIndex() const { return mCursor; }
+	inline const UserData& getObjectAt(int index) const { return mEntries.at(index).object; }
+
 protected:
 	void remove(typename std::vector<Entry>::iterator& it)
 	{
@@ -23,7 +23,7 @@ Eigen::Vector2f ImageComponent::getCenter() const
 }
 
 ImageComponent::ImageComponent(Window* window) : GuiComponent(window), 
-	mTargetIsMax(false), mFlipX(false), mFlipY(false), mOrigin(0.0, 0.0), mTargetSize(0, 0), mColorShift(0xFFFFFFFF)
+	mTargetSize(0, 0), mOrigin(0.0, 0.0), mFlipX(false), mFlipY(false), mTargetIsMax(false), mAsync(false), mPinned(true), mWaitingForTexture(false), mTextureRect(0, 0, 1, 1), mColorShift(0xFFFFFFFF)
 {
 	updateColors();
 }
@@ -93,8 +93,13 @@ void ImageComponent::resize()
 
 	if(svg)
 	{
-		// mSize.y() should already be rounded
-		svg->rasterizeAt((int)round(mSize.x()), (int)round(mSize.y()));
+		// switch to the SVG rasterized at the size we draw it at (mSize.y() should already be rounded)
+		const Eigen::Vector2i rasterSize((int)round(mSize.x()), (int)round(mSize.y()));
+		if(rasterSize.x() > 0 && rasterSize.y() > 0 && rasterSize != svg->getMaxSize())
+		{
+			mTexture = TextureResource::get(svg->getPath(), svg->isTiled(), mAsync, mPinned, rasterSize);
+			mWaitingForTexture = mTexture->isLoading();
+		}
 	}
 
 	onSizeChanged();
@@ -110,8 +115,9 @@ void ImageComponent::setImage(std::string path, bool tile)
 	if(path.empty() || !ResourceManager::getInstance()->fileExists(path))
 		mTexture.reset();
 	else
-		mTexture = TextureResource::get(path, tile);
+		mTexture = TextureResource::get(path, tile, mAsync, mPinned, SVGResource::isSVG(path) ? Eigen::Vector2i::Zero() : getMaxTextureSize()); // resize() picks the SVG's size
 
+	mWaitingForTexture = mTexture && mTexture->isLoading();
 	resize();
 }
 
@@ -122,12 +128,14 @@ void ImageComponent::setImage(const char* path, size_t length, bool tile)
 	mTexture = TextureResource::get("", tile);
 	mTexture->initFromMemory(path, length);
 	
+	mWaitingForTexture = false;
 	resize();
 }
 
 void ImageComponent::setImage(const std::shared_ptr<TextureResource>& texture)
 {
 	mTexture = texture;
+	mWaitingForTexture = mTexture && mTexture->isLoading();
 	resize();
 }
 
@@ -141,6 +149,7 @@ void ImageComponent::setResize(float width, float height)
 {
 	mTargetSize << width, height;
 	mTargetIsMax = false;
+	updateTextureSize();
 	resize();
 }
 
@@ -148,9 +157,42 @@ void ImageComponent::setMaxSize(float width, float height)
 {
 	mTargetSize << width, height;
 	mTargetIsMax = true;
+	updateTextureSize();
 	resize();
 }
 
+Eigen::Vector2i ImageComponent::getMaxTextureSize() const
+{
+	// fitting a stretched image into its target would lose resolution on whichever axis gets stretched more
+	if(!mTargetIsMax && mTargetSize.x() && mTargetSize.y())
+		return Eigen::Vector2i::Zero();
+
+	return Eigen::Vector2i((int)ceil(mTargetSize.x()), (int)ceil(mTargetSize.y()));
+}
+
+void ImageComponent::updateTextureSize()
+{
+	// SVGs get rasterized at the right size in resize()
+	if(!mTexture || mTexture->getMaxSize().isZero() || dynamic_cast<SVGResource*>(mTexture.get()))
+		return;
+
+	const Eigen::Vector2i& loadedMax = mTexture->getMaxSize();
+	const Eigen::Vector2i wantedMax = getMaxTextureSize();
+
+	bool bigEnough = true;
+	for(int i = 0; i < 2; i++)
+	{
+		if(loadedMax[i] != 0 && (wantedMax[i] == 0 || wantedMax[i] > loadedMax[i]))
+			bigEnough = false;
+	}
+
+	if(bigEnough)
+		return;
+
+	mTexture = TextureResource::get(mTexture->getPath(), mTexture->isTiled(), mAsync, mPinned, wantedMax);
+	mWaitingForTexture = mTexture->isLoading();
+}
+
 void ImageComponent::setFlipX(bool flip)
 {
 	mFlipX = flip;
@@ -230,15 +272,33 @@ void ImageComponent::updateVertices()
 		for(int i = 1; i < 6; i++)
 			mVertices[i].tex[1] = mVertices[i].tex[1] == py ? 0 : py;
 	}
+
+	// the image might only be part of the texture (see TextureAtlas)
+	mTextureRect = mTexture->getTextureRect();
+	const Eigen::Vector4f& rect = mTextureRect;
+	for(int i = 0; i < 6; i++)
+	{
+		mVertices[i].tex << rect[0] + mVertices[i].tex.x() * (rect[2] - rect[0]),
+			rect[1] + mVertices[i].tex.y() * (rect[3] - rect[1]);
+	}
 }
 
 void ImageComponent::updateColors()
 {
-	Renderer::buildGLColorArray(mColors, mColorShift, 6);
+	const GLuint color = Renderer::convertColor(mColorShift);
+	for(int i = 0; i < 6; i++)
+		mVertices[i].color = color;
 }
 
 void ImageComponent::render(const Eigen::Affine3f& parentTrans)
 {
+	// our size depends on the texture's, which we didn't know until now
+	if(mWaitingForTexture && !mTexture->isLoading())
+	{
+		mWaitingForTexture = false;
+		resize();
+	}
+
 	Eigen::Affine3f trans = roundMatrix(parentTrans * getTransform());
 	Renderer::setMatrix(trans);
 	
@@ -246,30 +306,14 @@ void ImageComponent::render(const Eigen::Affine3f& parentTrans)
 	{
 		if(mTexture->isInitialized())
 		{
-			// actually draw the image
-			mTexture->bind();
+			// the texture was reloaded and ended up somewhere else in its atlas
+			if(mTexture->getTextureRect() != mTextureRect)
+				updateVertices();
 
-			glEnable(GL_TEXTURE_2D);
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-
-			glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-			glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-			glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY);
-
-			glDisable(GL_TEXTURE_2D);
-			glDisable(GL_BLEND);
-		}else{
+			// actually draw the image
+			Renderer::drawTriangles(mVertices, 6, mTexture->getTextureID());
+		}else if(!mTexture->isLoading())
+		{
 			LOG(LogError) << "Image texture is not initialized!";
 			mTexture.reset();
 		}
@@ -8,6 +8,7 @@
 #include <string>
 #include <memory>
 #include "resources/TextureResource.h"
+#include "Renderer.h"
 
 class ImageComponent : public GuiComponent
 {
@@ -22,6 +23,21 @@ public:
 	//Use an already existing texture.
 	void setImage(const std::shared_ptr<TextureResource>& texture);
 
+	// If set, images loaded with setImage(path) are decoded in the background. Nothing is drawn until the
+	// texture is ready, and the component resizes itself when it is.
+	inline void setAsync(bool async) { mAsync = async; }
+
+	// Unpinned images are the first to be dropped from the texture cache when it goes over budget (default is pinned).
+	// Use this for things like box art, where there are a lot of images and only a few are on screen at once.
+	inline void setPinned(bool pinned) { mPinned = pinned; }
+
+	// The size textures are scaled down to on load, based on setResize()/setMaxSize() (a component of 0 means no limit).
+	// Scaling keeps the aspect ratio, so an image stretched to both sizes of setResize() isn't scaled down at all.
+	Eigen::Vector2i getMaxTextureSize() const;
+
+	// True if we have an image but it's still being decoded in the background (see setAsync()).
+	inline bool isLoading() const { return mTexture && mTexture->isLoading(); }
+
 	void onSizeChanged() override;
 	void setOpacity(unsigned char opacity) override;
 
@@ -66,18 +82,19 @@ private:
 	Eigen::Vector2f mOrigin;
 
 	bool mFlipX, mFlipY, mTargetIsMax;
+	bool mAsync;
+	bool mPinned;
+	bool mWaitingForTexture; // resize() once mTexture finishes loading
+	Eigen::Vector4f mTextureRect; // mTexture's getTextureRect() when mVertices were built
+
+	// Loads the texture again if it was scaled down to less than our current getMaxTextureSize().
+	void updateTextureSize();
 
 	// Calculates the correct mSize from our resizing information (set by setResize/setMaxSize).
 	// Used internally whenever the resizing parameters or texture change.
 	void resize();
 
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	} mVertices[6];
-
-	GLubyte mColors[6*4];
+	Renderer::Vertex mVertices[6];
 
 	void updateVertices();
 	void updateColors();
@@ -6,9 +6,9 @@
 #include "Util.h"
 
 NinePatchComponent::NinePatchComponent(Window* window, const std::string& path, unsigned int edgeColor, unsigned int centerColor) : GuiComponent(window),
-	mEdgeColor(edgeColor), mCenterColor(centerColor), 
+	mVertices(NULL),
 	mPath(path),
-	mVertices(NULL), mColors(NULL)
+	mEdgeColor(edgeColor), mCenterColor(centerColor), mTextureRect(0, 0, 1, 1)
 {
 	if(!mPath.empty())
 		buildVertices();
@@ -18,15 +18,17 @@ NinePatchComponent::~NinePatchComponent()
 {
 	if (mVertices != NULL)
 		delete[] mVertices;
-
-	if (mColors != NULL)
-		delete[] mColors;
 }
 
 void NinePatchComponent::updateColors()
 {
-	Renderer::buildGLColorArray(mColors, mEdgeColor, 6 * 9);
-	Renderer::buildGLColorArray(&mColors[4 * 6 * 4], mCenterColor, 6);
+	if(mVertices == NULL)
+		return;
+
+	const GLuint edgeColor = Renderer::convertColor(mEdgeColor);
+	const GLuint centerColor = Renderer::convertColor(mCenterColor);
+	for(int i = 0; i < 6 * 9; i++)
+		mVertices[i].color = (i >= 4 * 6 && i < 5 * 6) ? centerColor : edgeColor;
 }
 
 void NinePatchComponent::buildVertices()
@@ -34,21 +36,16 @@ void NinePatchComponent::buildVertices()
 	if(mVertices != NULL)
 		delete[] mVertices;
 
-	if(mColors != NULL)
-		delete[] mColors;
-
 	mTexture = TextureResource::get(mPath);
 
 	if(mTexture->getSize() == Eigen::Vector2i::Zero())
 	{
 		mVertices = NULL;
-		mColors = NULL;
 		LOG(LogWarning) << "NinePatchComponent missing texture!";
 		return;
 	}
 
-	mVertices = new Vertex[6 * 9];
-	mColors = new GLubyte[6 * 9 * 4];
+	mVertices = new Renderer::Vertex[6 * 9];
 	updateColors();
 
 	const Eigen::Vector2f ts = mTexture->getSize().cast<float>();
@@ -132,10 +129,14 @@ void NinePatchComponent::buildVertices()
 		v += 6;
 	}
 
-	// round vertices
+	// round vertices, and move the texture coordinates to wherever the image is in the texture (see TextureAtlas)
+	mTextureRect = mTexture->getTextureRect();
+	const Eigen::Vector4f& rect = mTextureRect;
 	for(int i = 0; i < 6*9; i++)
 	{
 		mVertices[i].pos = roundVector(mVertices[i].pos);
+		mVertices[i].tex << rect[0] + mVertices[i].tex.x() * (rect[2] - rect[0]),
+			rect[1] + mVertices[i].tex.y() * (rect[3] - rect[1]);
 	}
 }
 
@@ -143,32 +144,15 @@ void NinePatchComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = roundMatrix(parentTrans * getTransform());
 	
+	// the texture was reloaded and ended up somewhere else in its atlas
+	if(mTexture && mVertices != NULL && mTexture->getTextureRect() != mTextureRect)
+		buildVertices();
+
 	if(mTexture && mVertices != NULL)
 	{
 		Renderer::setMatrix(trans);
 
-		mTexture->bind();
-
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-		glDrawArrays(GL_TRIANGLES, 0, 6 * 9);
-
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
-
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+		Renderer::drawTriangles(mVertices, 6 * 9, mTexture->getTextureID());
 	}
 
 	renderChildren(trans);
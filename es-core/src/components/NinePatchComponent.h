@@ -2,6 +2,7 @@
 
 #include "GuiComponent.h"
 #include "resources/TextureResource.h"
+#include "Renderer.h"
 
 // Display an image in a way so that edges don't get too distorted no matter the final size. Useful for UI elements like backgrounds, buttons, etc.
 // This is accomplished by splitting an image into 9 pieces:
@@ -38,17 +39,11 @@ private:
 	void buildVertices();
 	void updateColors();
 
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	};
-
-	Vertex* mVertices;
-	GLubyte* mColors;
+	Renderer::Vertex* mVertices;
 
 	std::string mPath;
 	unsigned int mEdgeColor;
 	unsigned int mCenterColor;
 	std::shared_ptr<TextureResource> mTexture;
+	Eigen::Vector4f mTextureRect; // mTexture's getTextureRect() when mVertices were built
 };
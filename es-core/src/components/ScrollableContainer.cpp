@@ -103,8 +103,21 @@ void ScrollableContainer::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool ScrollableContainer::isAnimating() const
+{
+	// auto scrolling only moves anything if there's something to scroll to
+	if(mAutoScrollSpeed != 0)
+	{
+		const Eigen::Vector2f contentSize = getContentSize();
+		if((mScrollDir.x() != 0 && contentSize.x() > getSize().x()) || (mScrollDir.y() != 0 && contentSize.y() > getSize().y()))
+			return true;
+	}
+
+	return GuiComponent::isAnimating();
+}
+
 //this should probably return a box to allow for when controls don't start at 0,0
-Eigen::Vector2f ScrollableContainer::getContentSize()
+Eigen::Vector2f ScrollableContainer::getContentSize() const
 {
 	Eigen::Vector2f max(0, 0);
 	for(unsigned int i = 0; i < mChildren.size(); i++)
@@ -13,10 +13,11 @@ public:
 	void reset();
 
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 
 private:
-	Eigen::Vector2f getContentSize();
+	Eigen::Vector2f getContentSize() const;
 
 	Eigen::Vector2f mScrollPos;
 	Eigen::Vector2f mScrollDir;
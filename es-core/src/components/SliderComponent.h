@@ -18,6 +18,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 	
 	void onSizeChanged() override;
@@ -151,6 +151,11 @@ void TextEditComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool TextEditComponent::isAnimating() const
+{
+	return mCursorRepeatDir != 0 || GuiComponent::isAnimating();
+}
+
 void TextEditComponent::updateCursorRepeat(int deltaTime)
 {
 	if(mCursorRepeatDir == 0)
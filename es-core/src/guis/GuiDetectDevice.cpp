@@ -112,3 +112,8 @@ void GuiDetectDevice::update(int deltaTime)
 		}
 	}
 }
+
+bool GuiDetectDevice::isAnimating() const
+{
+	return mHoldingConfig != NULL || GuiComponent::isAnimating();
+}
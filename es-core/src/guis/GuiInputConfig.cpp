@@ -204,6 +204,12 @@ void GuiInputConfig::update(int deltaTime)
 	}
 }
 
+bool GuiInputConfig::isAnimating() const
+{
+	// counting down the "hold to skip" text
+	return (mConfiguringRow && mHoldingInput) || GuiComponent::isAnimating();
+}
+
 // move cursor to the next thing if we're configuring all, 
 // or come out of "configure mode" if we were only configuring one row
 void GuiInputConfig::rowDone()
@@ -1,17 +1,24 @@
 #include "resources/Font.h"
+#include FT_SIZES_H
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <string.h>
 #include <boost/filesystem.hpp>
 #include "Renderer.h"
 #include "Log.h"
 #include "Util.h"
 
+// text caches with at least this many vertices in a texture get their own vertex buffer instead of going through the batch
+// (smaller ones are cheaper to batch up with everything else around them)
+#define TEXT_BUFFER_MIN_VERTS 600
+
 FT_Library Font::sLibrary = NULL;
 
 int Font::getSize() const { return mSize; }
 
 std::map< std::pair<std::string, int>, std::weak_ptr<Font> > Font::sFontMap;
+std::map< std::string, std::weak_ptr<Font::FontFace> > Font::sFaceMap;
 
 
 // utf8 stuff
@@ -136,13 +143,59 @@ UnicodeChar Font::readUnicodeChar(const std::string& str, size_t& cursor)
 	return 0;
 }
 
+UnicodeChar Font::decodeMultiByteChar(const char*& str, const char* end)
+{
+	const unsigned char c = (unsigned char)*str;
+
+	// how many continuation (10xxxxxx) bytes follow, and what's left of the first byte
+	int length;
+	UnicodeChar val;
+	if((c & 0xE0) == 0xC0) // 110xxxxx
+	{
+		length = 1;
+		val = c & 0x1F;
+	}else if((c & 0xF0) == 0xE0) // 1110xxxx
+	{
+		length = 2;
+		val = c & 0x0F;
+	}else if((c & 0xF8) == 0xF0) // 11110xxx
+	{
+		length = 3;
+		val = c & 0x07;
+	}else{
+		// stray continuation byte or garbage
+		str++;
+		return 0;
+	}
+
+	if(end - str <= length)
+	{
+		// cut off
+		str = end;
+		return 0;
+	}
+
+	for(int i = 1; i <= length; i++)
+	{
+		if((str[i] & 0xC0) != 0x80)
+		{
+			// not a continuation byte, so this one's invalid - start again from there
+			str += i;
+			return 0;
+		}
+
+		val = (val << 6) | (str[i] & 0x3F);
+	}
+
+	str += length + 1;
+	return val;
+}
+
 
-Font::FontFace::FontFace(ResourceData&& d, int size) : data(d)
+Font::FontFace::FontFace(ResourceData&& d) : data(d), face(NULL)
 {
-	int err = FT_New_Memory_Face(sLibrary, data.ptr.get(), data.length, 0, &face);
-	assert(!err);
-	
-	FT_Set_Pixel_Sizes(face, 0, size);
+	if(!data.ptr || FT_New_Memory_Face(sLibrary, data.ptr.get(), data.length, 0, &face))
+		face = NULL;
 }
 
 Font::FontFace::~FontFace()
@@ -151,6 +204,44 @@ Font::FontFace::~FontFace()
 		FT_Done_Face(face);
 }
 
+Font::FontFaceSize::FontFaceSize(const std::shared_ptr<FontFace>& f, int pixelSize) : face(f), size(NULL)
+{
+	if(!face->face || FT_New_Size(face->face, &size))
+	{
+		size = NULL;
+		return;
+	}
+
+	FT_Activate_Size(size);
+	FT_Set_Pixel_Sizes(face->face, 0, pixelSize);
+}
+
+Font::FontFaceSize::~FontFaceSize()
+{
+	// has to go before the face does
+	if(size)
+		FT_Done_Size(size);
+}
+
+std::shared_ptr<Font::FontFace> Font::getFace(const std::string& path)
+{
+	auto it = sFaceMap.find(path);
+	if(it != sFaceMap.end())
+	{
+		std::shared_ptr<FontFace> face = it->second.lock();
+		if(face)
+			return face;
+	}
+
+	ResourceData data = ResourceManager::getInstance()->getFileData(path);
+	std::shared_ptr<FontFace> face(new FontFace(std::move(data)));
+	if(!face->face)
+		LOG(LogError) << "Could not load font face " << path;
+
+	sFaceMap[path] = face;
+	return face;
+}
+
 void Font::initLibrary()
 {
 	assert(sLibrary == NULL);
@@ -165,10 +256,7 @@ size_t Font::getMemUsage() const
 {
 	size_t memUsage = 0;
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
-		memUsage += it->textureSize.x() * it->textureSize.y() * 4;
-
-	for(auto it = mFaceCache.begin(); it != mFaceCache.end(); it++)
-		memUsage += it->second->data.length;
+		memUsage += (*it)->textureSize.x() * (*it)->textureSize.y() * 4;
 
 	return memUsage;
 }
@@ -190,6 +278,14 @@ size_t Font::getTotalMemUsage()
 		it++;
 	}
 
+	// font files, counted once however many sizes share them
+	for(auto face = sFaceMap.begin(); face != sFaceMap.end(); face++)
+	{
+		std::shared_ptr<FontFace> loaded = face->second.lock();
+		if(loaded)
+			total += loaded->data.length;
+	}
+
 	return total;
 }
 
@@ -198,6 +294,7 @@ Font::Font(int size, const std::string& path) : mSize(size), mPath(path)
 	assert(mSize > 0);
 	
 	mMaxGlyphHeight = 0;
+	memset(mGlyphTable, 0, sizeof(mGlyphTable));
 
 	if(!sLibrary)
 		initLibrary();
@@ -205,8 +302,6 @@ Font::Font(int size, const std::string& path) : mSize(size), mPath(path)
 	// always initialize ASCII characters
 	for(UnicodeChar i = 32; i < 128; i++)
 		getGlyph(i);
-
-	clearFaceCache();
 }
 
 Font::~Font()
@@ -246,7 +341,7 @@ void Font::unloadTextures()
 {
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
 	{
-		it->deinitTexture();
+		(*it)->deinitTexture();
 	}
 }
 
@@ -254,8 +349,7 @@ Font::FontTexture::FontTexture()
 {
 	textureId = 0;
 	textureSize << 2048, 512;
-	writePos = Eigen::Vector2i::Zero();
-	rowHeight = 0;
+	skyline.push_back(Eigen::Vector3i(0, 0, textureSize.x()));
 }
 
 Font::FontTexture::~FontTexture()
@@ -265,30 +359,78 @@ Font::FontTexture::~FontTexture()
 
 bool Font::FontTexture::findEmpty(const Eigen::Vector2i& size, Eigen::Vector2i& cursor_out)
 {
-	if(size.x() >= textureSize.x() || size.y() >= textureSize.y())
-		return false;
-
-	if(writePos.x() + size.x() >= textureSize.x() &&
-		writePos.y() + rowHeight + size.y() + 1 < textureSize.y())
+	// nothing to draw (e.g. a space), doesn't need any room
+	if(size.x() == 0 || size.y() == 0)
 	{
-		// row full, but it should fit on the next row
-		// move cursor to next row
-		writePos << 0, writePos.y() + rowHeight + 1; // leave 1px of space between glyphs
-		rowHeight = 0;
+		cursor_out = Eigen::Vector2i::Zero();
+		return true;
 	}
 
-	if(writePos.x() + size.x() >= textureSize.x() ||
-		writePos.y() + size.y() >= textureSize.y())
+	// leave 1px of space between glyphs
+	const int width = size.x() + 1;
+	const int height = size.y() + 1;
+
+	// find the spot where the glyph's top ends up highest, preferring narrower segments to keep wide gaps for wide glyphs
+	int best = -1;
+	int bestY = textureSize.y();
+	int bestWidth = 0;
+	for(unsigned int i = 0; i < skyline.size(); i++)
 	{
-		// nope, still won't fit
-		return false;
+		if(skyline[i].x() + width > textureSize.x())
+			break;
+
+		// it has to sit on the highest segment underneath it
+		int y = 0;
+		int remaining = width;
+		for(unsigned int j = i; remaining > 0; j++)
+		{
+			y = std::max(y, skyline[j].y());
+			remaining -= skyline[j].z();
+		}
+
+		if(y + height > textureSize.y())
+			continue;
+
+		if(y < bestY || (y == bestY && skyline[i].z() < bestWidth))
+		{
+			best = i;
+			bestY = y;
+			bestWidth = skyline[i].z();
+		}
 	}
 
-	cursor_out = writePos;
-	writePos[0] += size.x() + 1; // leave 1px of space between glyphs
+	if(best == -1)
+		return false;
+
+	cursor_out << skyline[best].x(), bestY;
+
+	// raise the skyline where the glyph went, cutting back whatever segments it covers
+	const int right = cursor_out.x() + width;
+	skyline.insert(skyline.begin() + best, Eigen::Vector3i(cursor_out.x(), bestY + height, width));
+	for(unsigned int i = best + 1; i < skyline.size() && skyline[i].x() < right; )
+	{
+		const int cut = right - skyline[i].x();
+		if(cut >= skyline[i].z())
+		{
+			skyline.erase(skyline.begin() + i);
+		}else{
+			skyline[i].x() += cut;
+			skyline[i].z() -= cut;
+			break;
+		}
+	}
 
-	if(size.y() > rowHeight)
-		rowHeight = size.y();
+	// join neighbours at the same height
+	for(unsigned int i = 1; i < skyline.size(); )
+	{
+		if(skyline[i].y() == skyline[i - 1].y())
+		{
+			skyline[i - 1].z() += skyline[i].z();
+			skyline.erase(skyline.begin() + i);
+		}else{
+			i++;
+		}
+	}
 
 	return true;
 }
@@ -298,7 +440,7 @@ void Font::FontTexture::initTexture()
 	assert(textureId == 0);
 
 	glGenTextures(1, &textureId);
-	glBindTexture(GL_TEXTURE_2D, textureId);
+	Renderer::bindTexture(textureId);
 
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -316,27 +458,25 @@ void Font::FontTexture::deinitTexture()
 {
 	if(textureId != 0)
 	{
-		glDeleteTextures(1, &textureId);
+		Renderer::deleteTexture(textureId);
 		textureId = 0;
 	}
 }
 
 void Font::getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, FontTexture*& tex_out, Eigen::Vector2i& cursor_out)
 {
-	if(mTextures.size())
+	// check if any of our textures still have space
+	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
 	{
-		// check if the most recent texture has space
-		tex_out = &mTextures.back();
-
-		// will this one work?
+		tex_out = it->get();
 		if(tex_out->findEmpty(glyphSize, cursor_out))
-			return; // yes
+			return;
 	}
 
 	// current textures are full,
 	// make a new one
-	mTextures.push_back(FontTexture());
-	tex_out = &mTextures.back();
+	mTextures.push_back(std::unique_ptr<FontTexture>(new FontTexture()));
+	tex_out = mTextures.back().get();
 	tex_out->initTexture();
 	
 	bool ok = tex_out->findEmpty(glyphSize, cursor_out);
@@ -407,32 +547,32 @@ FT_Face Font::getFaceForChar(UnicodeChar id)
 	// look through our current font + fallback fonts to see if any have the glyph we're looking for
 	for(unsigned int i = 0; i < fallbackFonts.size() + 1; i++)
 	{
-		auto fit = mFaceCache.find(i);
-
-		if(fit == mFaceCache.end()) // doesn't exist yet
+		if(i == mFaces.size()) // haven't needed this one before
 		{
 			// i == 0 -> mPath
 			// otherwise, take from fallbackFonts
 			const std::string& path = (i == 0 ? mPath : fallbackFonts.at(i - 1));
-			ResourceData data = ResourceManager::getInstance()->getFileData(path);
-			mFaceCache[i] = std::unique_ptr<FontFace>(new FontFace(std::move(data), mSize));
-			fit = mFaceCache.find(i);
+			mFaces.push_back(std::unique_ptr<FontFaceSize>(new FontFaceSize(getFace(path), mSize)));
 		}
 
-		if(FT_Get_Char_Index(fit->second->face, id) != 0)
-			return fit->second->face;
+		const FontFaceSize& faceSize = *mFaces.at(i);
+		if(faceSize.size && FT_Get_Char_Index(faceSize.face->face, id) != 0)
+		{
+			FT_Activate_Size(faceSize.size);
+			return faceSize.face->face;
+		}
 	}
 
 	// nothing has a valid glyph - return the "real" face so we get a "missing" character
-	return mFaceCache.begin()->second->face;
-}
+	const FontFaceSize& primary = *mFaces.front();
+	if(!primary.size)
+		return NULL;
 
-void Font::clearFaceCache()
-{
-	mFaceCache.clear();
+	FT_Activate_Size(primary.size);
+	return primary.face->face;
 }
 
-Font::Glyph* Font::getGlyph(UnicodeChar id)
+Font::Glyph* Font::loadGlyph(UnicodeChar id)
 {
 	// is it already loaded?
 	auto it = mGlyphMap.find(id);
@@ -478,49 +618,68 @@ Font::Glyph* Font::getGlyph(UnicodeChar id)
 	glyph.advance << (float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f;
 	glyph.bearing << (float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f;
 
+	// keep a tightly packed copy of the bitmap (FreeType's rows can be padded)
+	glyph.bitmap.resize(glyphSize.x() * glyphSize.y());
+	for(int y = 0; y < glyphSize.y(); y++)
+		memcpy(&glyph.bitmap[y * glyphSize.x()], g->bitmap.buffer + y * g->bitmap.pitch, glyphSize.x());
+
 	// upload glyph bitmap to texture
-	glBindTexture(GL_TEXTURE_2D, tex->textureId);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, g->bitmap.buffer);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	if(!glyph.bitmap.empty())
+	{
+		Renderer::bindTexture(tex->textureId);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, glyph.bitmap.data());
+		Renderer::bindTexture(0);
+	}
 
 	// update max glyph height
 	if(glyphSize.y() > mMaxGlyphHeight)
 		mMaxGlyphHeight = glyphSize.y();
 
+	if(id < GLYPH_TABLE_SIZE)
+		mGlyphTable[id] = &glyph;
+
 	// done
 	return &glyph;
 }
 
 // completely recreate the texture data for all textures based on mGlyphs information
+// (from the bitmaps the glyphs kept - nothing is rasterized again, so coming back from a game is just an upload per texture)
 void Font::rebuildTextures()
 {
-	// recreate OpenGL textures
+	// lay each texture out in memory first
+	std::map< FontTexture*, std::vector<unsigned char> > pixels;
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
-	{
-		it->initTexture();
-	}
+		pixels[it->get()].resize((*it)->textureSize.x() * (*it)->textureSize.y(), 0);
 
-	// reupload the texture data
 	for(auto it = mGlyphMap.begin(); it != mGlyphMap.end(); it++)
 	{
-		FT_Face face = getFaceForChar(it->first);
-		FT_GlyphSlot glyphSlot = face->glyph;
+		const Glyph& glyph = it->second;
+		if(glyph.bitmap.empty())
+			continue;
 
-		// load the glyph bitmap through FT
-		FT_Load_Char(face, it->first, FT_LOAD_RENDER);
+		FontTexture* tex = glyph.texture;
+		std::vector<unsigned char>& texPixels = pixels[tex];
 
-		FontTexture* tex = it->second.texture;
-		
 		// find the position/size
-		Eigen::Vector2i cursor(it->second.texPos.x() * tex->textureSize.x(), it->second.texPos.y() * tex->textureSize.y());
-		Eigen::Vector2i glyphSize(it->second.texSize.x() * tex->textureSize.x(), it->second.texSize.y() * tex->textureSize.y());
-		
+		Eigen::Vector2i cursor(glyph.texPos.x() * tex->textureSize.x(), glyph.texPos.y() * tex->textureSize.y());
+		Eigen::Vector2i glyphSize(glyph.texSize.x() * tex->textureSize.x(), glyph.texSize.y() * tex->textureSize.y());
+
+		for(int y = 0; y < glyphSize.y(); y++)
+			memcpy(&texPixels[(cursor.y() + y) * tex->textureSize.x() + cursor.x()], &glyph.bitmap[y * glyphSize.x()], glyphSize.x());
+	}
+
+	// recreate OpenGL textures
+	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
+	{
+		FontTexture* tex = it->get();
+		tex->initTexture();
+
 		// upload to texture
-		glBindTexture(GL_TEXTURE_2D, tex->textureId);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, glyphSlot->bitmap.buffer);
+		Renderer::bindTexture(tex->textureId);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex->textureSize.x(), tex->textureSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, pixels[tex].data());
 	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	Renderer::bindTexture(0);
 }
 
 void Font::renderTextCache(TextCache* cache)
@@ -535,33 +694,27 @@ void Font::renderTextCache(TextCache* cache)
 	{
 		assert(*it->textureIdPtr != 0);
 
-		auto vertexList = *it;
-
-		glBindTexture(GL_TEXTURE_2D, *it->textureIdPtr);
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), it->verts[0].pos.data());
-		glTexCoordPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), it->verts[0].tex.data());
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, it->colors.data());
-
-		glDrawArrays(GL_TRIANGLES, 0, it->verts.size());
-
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		// big enough that uploading it once beats transforming it into the batch every frame
+		if(it->verts.size() >= TEXT_BUFFER_MIN_VERTS)
+		{
+			if(!Renderer::isBufferValid(it->buffer) || it->bufferDirty)
+			{
+				if(Renderer::uploadBuffer(it->buffer, it->verts.data(), it->verts.size()))
+					it->bufferDirty = false;
+			}
+
+			if(Renderer::isBufferValid(it->buffer))
+			{
+				Renderer::drawBuffer(it->buffer, *it->textureIdPtr);
+				continue;
+			}
+		}
 
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+		Renderer::drawTriangles(it->verts.data(), it->verts.size(), *it->textureIdPtr);
 	}
 }
 
-Eigen::Vector2f Font::sizeText(std::string text, float lineSpacing)
+Eigen::Vector2f Font::sizeText(const std::string& text, float lineSpacing)
 {
 	float lineWidth = 0.0f;
 	float highestWidth = 0.0f;
@@ -570,10 +723,15 @@ Eigen::Vector2f Font::sizeText(std::string text, float lineSpacing)
 
 	float y = lineHeight;
 
-	size_t i = 0;
-	while(i < text.length())
+	const char* str = text.data();
+	const char* end = str + text.length();
+	while(str != end)
 	{
-		UnicodeChar character = readUnicodeChar(text, i); // advances i
+		UnicodeChar character = decodeUnicodeChar(str, end); // advances str
+
+		// invalid character
+		if(character == 0)
+			continue;
 
 		if(character == (UnicodeChar)'\n')
 		{
@@ -582,6 +740,7 @@ Eigen::Vector2f Font::sizeText(std::string text, float lineSpacing)
 
 			lineWidth = 0.0f;
 			y += lineHeight;
+			continue; // takes no space when drawn (see buildTextCache())
 		}
 
 		Glyph* glyph = getGlyph(character);
@@ -607,78 +766,124 @@ float Font::getLetterHeight()
 	return glyph->texSize.y() * glyph->texture->textureSize.y();
 }
 
-//the worst algorithm ever written
-//breaks up a normal string with newlines to make it fit xLen
-std::string Font::wrapText(std::string text, float xLen)
+// words are broken after whitespace - each one keeps its trailing space/tab, so that counts towards whether it fits.
+// a word that doesn't fit goes on a line of its own (even if it's still too long there).
+Font::WrapInfo Font::getWrapInfo(const std::string& text, float xLen)
 {
-	std::string out;
+	WrapInfo info;
+	info.lines = 1;
+	info.width = 0.0f;
+
+	float lineWidth = 0.0f; // everything on the current line before wordStart
+	float wordWidth = 0.0f;
+	size_t lineStart = 0;
+	size_t wordStart = 0;
+
+	const char* const start = text.data();
+	const char* const end = start + text.length();
+	const char* str = start;
+	while(str != end)
+	{
+		UnicodeChar character = decodeUnicodeChar(str, end); // advances str
 
-	std::string line, word, temp;
-	size_t space;
+		if(character != 0 && character != (UnicodeChar)'\n')
+		{
+			Glyph* glyph = getGlyph(character);
+			if(glyph)
+				wordWidth += glyph->advance.x();
+		}
 
-	Eigen::Vector2f textSize;
+		if(character != (UnicodeChar)' ' && character != (UnicodeChar)'\t' && character != (UnicodeChar)'\n' && str != end)
+			continue;
 
-	while(text.length() > 0) //while there's text or we still have text to render
-	{
-		space = text.find_first_of(" \t\n");
-		if(space == std::string::npos)
-			space = text.length() - 1;
+		const size_t cursor = str - start;
 
-		word = text.substr(0, space + 1);
-		text.erase(0, space + 1);
+		// end of a word - if it doesn't fit, it starts a new line
+		if(lineWidth + wordWidth > xLen && wordStart != lineStart)
+		{
+			info.breaks.push_back(wordStart);
+			info.lines++;
 
-		temp = line + word;
+			if(lineWidth > info.width)
+				info.width = lineWidth;
 
-		textSize = sizeText(temp);
+			lineWidth = 0.0f;
+			lineStart = wordStart;
+		}
 
-		// if the word will fit on the line, add it to our line, and continue
-		if(textSize.x() <= xLen)
+		lineWidth += wordWidth;
+		wordWidth = 0.0f;
+		wordStart = cursor;
+
+		if(character == (UnicodeChar)'\n')
 		{
-			line = temp;
-			continue;
-		}else{
-			// the next word won't fit, so break here
-			out += line + '\n';
-			line = word;
+			info.lines++;
+
+			if(lineWidth > info.width)
+				info.width = lineWidth;
+
+			lineWidth = 0.0f;
+			lineStart = cursor;
 		}
 	}
 
-	// whatever's left should fit
-	out += line;
+	if(lineWidth > info.width)
+		info.width = lineWidth;
 
+	return info;
+}
+
+//breaks up a normal string with newlines to make it fit xLen
+std::string Font::wrapText(const std::string& text, float xLen)
+{
+	const WrapInfo wrap = getWrapInfo(text, xLen);
+
+	std::string out;
+	out.reserve(text.length() + wrap.breaks.size());
+
+	size_t start = 0;
+	for(auto it = wrap.breaks.begin(); it != wrap.breaks.end(); it++)
+	{
+		out.append(text, start, *it - start);
+		out += '\n';
+		start = *it;
+	}
+
+	out.append(text, start, std::string::npos);
 	return out;
 }
 
-Eigen::Vector2f Font::sizeWrappedText(std::string text, float xLen, float lineSpacing)
+Eigen::Vector2f Font::sizeWrappedText(const std::string& text, float xLen, float lineSpacing)
 {
-	text = wrapText(text, xLen);
-	return sizeText(text, lineSpacing);
+	const WrapInfo wrap = getWrapInfo(text, xLen);
+	return Eigen::Vector2f(wrap.width, wrap.lines * getHeight(lineSpacing));
 }
 
-Eigen::Vector2f Font::getWrappedTextCursorOffset(std::string text, float xLen, size_t stop, float lineSpacing)
+Eigen::Vector2f Font::getWrappedTextCursorOffset(const std::string& text, float xLen, size_t stop, float lineSpacing)
 {
-	std::string wrappedText = wrapText(text, xLen);
+	const WrapInfo wrap = getWrapInfo(text, xLen);
+	auto nextBreak = wrap.breaks.begin();
 
 	float lineWidth = 0.0f;
 	float y = 0.0f;
 
-	size_t wrapCursor = 0;
 	size_t cursor = 0;
-	while(cursor < stop)
+	while(cursor < stop && cursor < text.length())
 	{
-		UnicodeChar wrappedCharacter = readUnicodeChar(wrappedText, wrapCursor);
-		UnicodeChar character = readUnicodeChar(text, cursor);
-
-		if(wrappedCharacter == (UnicodeChar)'\n' && character != (UnicodeChar)'\n')
+		if(nextBreak != wrap.breaks.end() && *nextBreak == cursor)
 		{
-			//this is where the wordwrap inserted a newline
-			//reset lineWidth and increment y, but don't consume a cursor character
+			//this is where the wordwrap inserts a newline
 			lineWidth = 0.0f;
 			y += getHeight(lineSpacing);
+			nextBreak++;
+		}
+
+		const char* str = text.data() + cursor;
+		UnicodeChar character = decodeUnicodeChar(str, text.data() + text.length());
+		cursor = str - text.data();
 
-			cursor = getPrevCursor(text, cursor); // unconsume
+		if(character == 0)
 			continue;
-		}
 
 		if(character == (UnicodeChar)'\n')
 		{
@@ -701,23 +906,25 @@ Eigen::Vector2f Font::getWrappedTextCursorOffset(std::string text, float xLen, s
 
 float Font::getNewlineStartOffset(const std::string& text, const unsigned int& charStart, const float& xLen, const Alignment& alignment)
 {
-	switch(alignment)
-	{
-	case ALIGN_LEFT:
-		return 0;
-	case ALIGN_CENTER:
-		{
-			unsigned int endChar = text.find('\n', charStart);
-			return (xLen - sizeText(text.substr(charStart, endChar != std::string::npos ? endChar - charStart : endChar)).x()) / 2.0f;
-		}
-	case ALIGN_RIGHT:
-		{
-			unsigned int endChar = text.find('\n', charStart);
-			return xLen - (sizeText(text.substr(charStart, endChar != std::string::npos ? endChar - charStart : endChar)).x());
-		}
-	default:
+	if(alignment != ALIGN_CENTER && alignment != ALIGN_RIGHT)
 		return 0;
+
+	// width of the line starting at charStart
+	float lineWidth = 0.0f;
+	const char* str = text.data() + charStart;
+	const char* end = text.data() + text.length();
+	while(str != end && *str != '\n')
+	{
+		UnicodeChar character = decodeUnicodeChar(str, end); // advances str
+		if(character == 0)
+			continue;
+
+		Glyph* glyph = getGlyph(character);
+		if(glyph)
+			lineWidth += glyph->advance.x();
 	}
+
+	return alignment == ALIGN_CENTER ? (xLen - lineWidth) / 2.0f : xLen - lineWidth;
 }
 
 inline float font_round(float v)
@@ -736,12 +943,14 @@ TextCache* Font::buildTextCache(const std::string& text, Eigen::Vector2f offset,
 	// vertices by texture
 	std::map< FontTexture*, std::vector<TextCache::Vertex> > vertMap;
 
-	size_t cursor = 0;
+	const char* const start = text.data();
+	const char* const end = start + text.length();
+	const char* str = start;
 	UnicodeChar character;
 	Glyph* glyph;
-	while(cursor < text.length())
+	while(str != end)
 	{
-		character = readUnicodeChar(text, cursor); // also advances cursor
+		character = decodeUnicodeChar(str, end); // also advances str
 
 		// invalid character
 		if(character == 0)
@@ -750,7 +959,7 @@ TextCache* Font::buildTextCache(const std::string& text, Eigen::Vector2f offset,
 		if(character == (UnicodeChar)'\n')
 		{
 			y += getHeight(lineSpacing);
-			x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, cursor /* cursor is already advanced */, xLen, alignment) : 0);
+			x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, str - start /* str is already advanced */, xLen, alignment) : 0);
 			continue;
 		}
 
@@ -806,13 +1015,11 @@ TextCache* Font::buildTextCache(const std::string& text, Eigen::Vector2f offset,
 		TextCache::VertexList& vertList = cache->vertexLists.at(i);
 
 		vertList.textureIdPtr = &it->first->textureId;
-		vertList.verts = it->second;
-
-		vertList.colors.resize(4 * it->second.size());
-		Renderer::buildGLColorArray(vertList.colors.data(), color, it->second.size());
+		vertList.verts = std::move(it->second);
+		i++;
 	}
 
-	clearFaceCache();
+	cache->setColor(color);
 
 	return cache;
 }
@@ -822,10 +1029,22 @@ TextCache* Font::buildTextCache(const std::string& text, float offsetX, float of
 	return buildTextCache(text, Eigen::Vector2f(offsetX, offsetY), color, 0.0f);
 }
 
+TextCache::~TextCache()
+{
+	for(auto it = vertexLists.begin(); it != vertexLists.end(); it++)
+		Renderer::deleteBuffer(it->buffer);
+}
+
 void TextCache::setColor(unsigned int color)
 {
+	const GLuint colorGl = Renderer::convertColor(color);
 	for(auto it = vertexLists.begin(); it != vertexLists.end(); it++)
-		Renderer::buildGLColorArray(it->colors.data(), color, it->verts.size());
+	{
+		for(auto vert = it->verts.begin(); vert != it->verts.end(); vert++)
+			vert->color = colorGl;
+
+		it->bufferDirty = true;
+	}
 }
 
 std::shared_ptr<Font> Font::getFromTheme(const ThemeData::ThemeElement* elem, unsigned int properties, const std::shared_ptr<Font>& orig)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include "platform.h"
 #include GLHEADER
 #include <ft2build.h>
@@ -8,6 +9,7 @@
 #include <Eigen/Dense>
 #include "resources/ResourceManager.h"
 #include "ThemeData.h"
+#include "Renderer.h"
 
 class TextCache;
 
@@ -38,14 +40,14 @@ public:
 
 	virtual ~Font();
 
-	Eigen::Vector2f sizeText(std::string text, float lineSpacing = 1.5f); // Returns the expected size of a string when rendered.  Extra spacing is applied to the Y axis.
+	Eigen::Vector2f sizeText(const std::string& text, float lineSpacing = 1.5f); // Returns the expected size of a string when rendered.  Extra spacing is applied to the Y axis.
 	TextCache* buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color);
 	TextCache* buildTextCache(const std::string& text, Eigen::Vector2f offset, unsigned int color, float xLen, Alignment alignment = ALIGN_LEFT, float lineSpacing = 1.5f);
 	void renderTextCache(TextCache* cache);
 	
-	std::string wrapText(std::string text, float xLen); // Inserts newlines into text to make it wrap properly.
-	Eigen::Vector2f sizeWrappedText(std::string text, float xLen, float lineSpacing = 1.5f); // Returns the expected size of a string after wrapping is applied.
-	Eigen::Vector2f getWrappedTextCursorOffset(std::string text, float xLen, size_t cursor, float lineSpacing = 1.5f); // Returns the position of of the cursor after moving "cursor" characters.
+	std::string wrapText(const std::string& text, float xLen); // Inserts newlines into text to make it wrap properly.
+	Eigen::Vector2f sizeWrappedText(const std::string& text, float xLen, float lineSpacing = 1.5f); // Returns the expected size of a string after wrapping is applied.
+	Eigen::Vector2f getWrappedTextCursorOffset(const std::string& text, float xLen, size_t cursor, float lineSpacing = 1.5f); // Returns the position of of the cursor after moving "cursor" characters.
 
 	float getHeight(float lineSpacing = 1.5f) const;
 	float getLetterHeight();
@@ -69,8 +71,20 @@ public:
 	static size_t moveCursor(const std::string& str, size_t cursor, int moveAmt); // negative moveAmt = move backwards, positive = move forwards
 	static UnicodeChar readUnicodeChar(const std::string& str, size_t& cursor); // reads unicode character at cursor AND moves cursor to the next valid unicode char
 
+	// Reads the character at str and moves str past it, never reading past end - for going through a whole string at once, which
+	// the text layout functions do for everything they draw or measure. ASCII is handled inline, and invalid bytes come out as 0 one at a time.
+	static inline UnicodeChar decodeUnicodeChar(const char*& str, const char* end)
+	{
+		if((*str & 0x80) == 0)
+			return (UnicodeChar)*str++;
+
+		return decodeMultiByteChar(str, end);
+	}
+
 private:
 	static FT_Library sLibrary;
+
+	static UnicodeChar decodeMultiByteChar(const char*& str, const char* end);
 	static std::map< std::pair<std::string, int>, std::weak_ptr<Font> > sFontMap;
 
 	Font(int size, const std::string& path);
@@ -80,8 +94,9 @@ private:
 		GLuint textureId;
 		Eigen::Vector2i textureSize;
 
-		Eigen::Vector2i writePos;
-		int rowHeight;
+		// the top edge of what's been packed so far, as segments (x, y, width) from left to right. a new glyph goes wherever it ends up
+		// highest (lowest y), so short glyphs fill in next to tall ones instead of every row being as tall as its tallest glyph.
+		std::vector<Eigen::Vector3i> skyline;
 
 		FontTexture();
 		~FontTexture();
@@ -92,25 +107,40 @@ private:
 		void deinitTexture(); // deinitializes the OpenGL texture if any exists, is automatically called in the destructor
 	};
 
+	// A font file loaded into FreeType, shared by every Font that uses the file (whatever its size).
 	struct FontFace
 	{
 		const ResourceData data;
-		FT_Face face;
+		FT_Face face; // NULL if it couldn't be loaded
 
-		FontFace(ResourceData&& d, int size);
+		FontFace(ResourceData&& d);
 		virtual ~FontFace();
 	};
 
+	// A Font's own size on a shared FontFace (FT_New_Size), activated before anything is loaded from the face.
+	struct FontFaceSize
+	{
+		std::shared_ptr<FontFace> face;
+		FT_Size size; // NULL if the face couldn't be loaded
+
+		FontFaceSize(const std::shared_ptr<FontFace>& f, int pixelSize);
+		~FontFaceSize();
+	};
+
+	static std::map< std::string, std::weak_ptr<FontFace> > sFaceMap;
+	static std::shared_ptr<FontFace> getFace(const std::string& path); // loads it if nothing has it loaded already
+
 	void rebuildTextures();
 	void unloadTextures();
 
-	std::vector<FontTexture> mTextures;
+	std::vector< std::unique_ptr<FontTexture> > mTextures; // never moved once created, glyphs and TextCaches point to them
 
 	void getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, FontTexture*& tex_out, Eigen::Vector2i& cursor_out);
 
-	std::map< unsigned int, std::unique_ptr<FontFace> > mFaceCache;
-	FT_Face getFaceForChar(UnicodeChar id);
-	void clearFaceCache();
+	// mPath's face, then the fallback fonts (in getFallbackFontPaths() order) - each one is only loaded once a glyph turns up
+	// that none of the ones before it have
+	std::vector< std::unique_ptr<FontFaceSize> > mFaces;
+	FT_Face getFaceForChar(UnicodeChar id); // with our size active on it
 
 	struct Glyph
 	{
@@ -121,11 +151,38 @@ private:
 
 		Eigen::Vector2f advance;
 		Eigen::Vector2f bearing;
+
+		// what was uploaded to the texture (texSize in texels, one byte per texel), so rebuildTextures() doesn't need FreeType
+		std::vector<unsigned char> bitmap;
 	};
 
-	std::map<UnicodeChar, Glyph> mGlyphMap;
+	std::unordered_map<UnicodeChar, Glyph> mGlyphMap;
+
+	// glyphs for the first GLYPH_TABLE_SIZE code points (ASCII and Latin-1, so nearly all of our text) are also indexed
+	// here directly, so they don't need a hash lookup. NULL until loaded. Points into mGlyphMap (its elements never move).
+	static const UnicodeChar GLYPH_TABLE_SIZE = 256;
+	Glyph* mGlyphTable[GLYPH_TABLE_SIZE];
 
-	Glyph* getGlyph(UnicodeChar id);
+	inline Glyph* getGlyph(UnicodeChar id)
+	{
+		if(id < GLYPH_TABLE_SIZE && mGlyphTable[id])
+			return mGlyphTable[id];
+
+		return loadGlyph(id);
+	}
+
+	Glyph* loadGlyph(UnicodeChar id); // the mGlyphMap lookup, creating the glyph if it doesn't exist yet
+
+	// Where text has to be broken to fit in xLen, worked out in one pass (each glyph is measured once).
+	// wrapText(), sizeWrappedText() and getWrappedTextCursorOffset() are all built on this.
+	struct WrapInfo
+	{
+		std::vector<size_t> breaks; // byte offsets in text that a newline goes in front of, in order
+		unsigned int lines; // once wrapped, counting the newlines that were already there
+		float width; // of the widest line once wrapped
+	};
+
+	WrapInfo getWrapInfo(const std::string& text, float xLen);
 
 	int mMaxGlyphHeight;
 	
@@ -144,22 +201,25 @@ private:
 class TextCache
 {
 protected:
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	};
+	typedef Renderer::Vertex Vertex;
 
 	struct VertexList
 	{
 		GLuint* textureIdPtr; // this is a pointer because the texture ID can change during deinit/reinit (when launching a game)
 		std::vector<Vertex> verts;
-		std::vector<GLubyte> colors;
+
+		// big lists are uploaded once and drawn from here instead of going through the batch (see Font::renderTextCache())
+		Renderer::VertexBuffer buffer;
+		bool bufferDirty; // verts changed since they were uploaded
+
+		VertexList() : textureIdPtr(NULL), bufferDirty(false) {}
 	};
 
 	std::vector<VertexList> vertexLists;
 
 public:
+	~TextCache();
+
 	struct CacheMetrics
 	{
 		Eigen::Vector2f size;
@@ -4,98 +4,117 @@
 #include "Log.h"
 #include "Util.h"
 #include "ImageIO.h"
+#include <algorithm>
 
 #define DPI 96
 
-SVGResource::SVGResource(const std::string& path, bool tile) : TextureResource(path, tile), mSVGImage(NULL)
+std::map< std::string, std::weak_ptr<NSVGimage> > SVGResource::sImages;
+
+SVGResource::SVGResource(const std::string& path, bool tile, const std::shared_ptr<NSVGimage>& image) : TextureResource(path, tile), mSVGImage(image)
 {
-	mLastWidth = 0;
-	mLastHeight = 0;
 }
 
 SVGResource::~SVGResource()
 {
-	deinitSVG();
 }
 
-void SVGResource::unload(std::shared_ptr<ResourceManager>& rm)
+bool SVGResource::isSVG(const std::string& path)
 {
-	deinitSVG();
-	TextureResource::unload(rm);
+	return path.size() >= 4 && path.substr(path.size() - 4, std::string::npos) == ".svg";
 }
 
-void SVGResource::initFromMemory(const char* file, size_t length)
+std::shared_ptr<NSVGimage> SVGResource::getImage(const std::string& path)
 {
-	deinit();
-	deinitSVG();
+	auto it = sImages.find(path);
+	if(it != sImages.end())
+	{
+		std::shared_ptr<NSVGimage> image = it->second.lock();
+		if(image)
+			return image;
+
+		sImages.erase(it);
+	}
+
+	const ResourceData data = ResourceManager::getInstance()->getFileData(path);
+	if(!data.ptr)
+		return NULL;
 
 	// nsvgParse excepts a modifiable, null-terminated string
-	char* copy = (char*)malloc(length + 1);
+	char* copy = (char*)malloc(data.length + 1);
 	assert(copy != NULL);
-	memcpy(copy, file, length);
-	copy[length] = '\0';
+	memcpy(copy, data.ptr.get(), data.length);
+	copy[data.length] = '\0';
 
-	mSVGImage = nsvgParse(copy, "px", DPI);
+	NSVGimage* parsed = nsvgParse(copy, "px", DPI);
 	free(copy);
 
-	if(!mSVGImage)
+	if(!parsed || parsed->width <= 0 || parsed->height <= 0)
 	{
-		LOG(LogError) << "Error parsing SVG image.";
-		return;
+		LOG(LogError) << "Error parsing SVG image \"" << path << "\".";
+		if(parsed)
+			nsvgDelete(parsed);
+		return NULL;
 	}
 
-	if(mLastWidth && mLastHeight)
-		rasterizeAt(mLastWidth, mLastHeight);
-	else
-		rasterizeAt((size_t)round(mSVGImage->width), (size_t)round(mSVGImage->height));
+	std::shared_ptr<NSVGimage> image(parsed, nsvgDelete);
+	sImages[path] = image;
+	return image;
 }
 
-void SVGResource::rasterizeAt(size_t width, size_t height)
+Eigen::Vector2i SVGResource::getRasterSize(const NSVGimage& image, const Eigen::Vector2i& size)
 {
-	if(!mSVGImage || (width == 0 && height == 0))
-		return;
+	int width = size.x();
+	int height = size.y();
 
-	if(width == 0)
+	if(width == 0 && height == 0)
+	{
+		width = (int)round(image.width);
+		height = (int)round(image.height);
+	}else if(width == 0)
 	{
 		// auto scale width to keep aspect
-		width = (size_t)round((height / mSVGImage->height) * mSVGImage->width);
+		width = (int)round((height / image.height) * image.width);
 	}else if(height == 0)
 	{
 		// auto scale height to keep aspect
-		height = (size_t)round((width / mSVGImage->width) * mSVGImage->height);
+		height = (int)round((width / image.width) * image.height);
 	}
 
-	if(width != (size_t)round(mSVGImage->width) && height != (size_t)round(mSVGImage->height))
-	{
-		mLastWidth = width;
-		mLastHeight = height;
-	}
+	return Eigen::Vector2i(std::max(width, 1), std::max(height, 1));
+}
 
-	unsigned char* imagePx = (unsigned char*)malloc(width * height * 4);
-	assert(imagePx != NULL);
+std::vector<unsigned char> SVGResource::rasterize(const NSVGimage& image, const Eigen::Vector2i& size)
+{
+	const size_t rowSize = size.x() * 4;
+	std::vector<unsigned char> raster(rowSize * size.y());
 
+	// the rasterizer only reads the image, so any number of threads can rasterize the same one
 	NSVGrasterizer* rast = nsvgCreateRasterizer();
-	nsvgRasterize(rast, mSVGImage, 0, 0, height / mSVGImage->height, imagePx, width, height, width * 4);
+	nsvgRasterize(rast, const_cast<NSVGimage*>(&image), 0, 0, size.y() / image.height, raster.data(), size.x(), size.y(), rowSize);
 	nsvgDeleteRasterizer(rast);
 
-	ImageIO::flipPixelsVert(imagePx, width, height);
-
-	initFromPixels(imagePx, width, height);
-	free(imagePx);
+	// nanosvg writes RGBA top row first, textures want the bottom row first - flip while copying out
+	std::vector<unsigned char> pixels(raster.size());
+	ImageIO::copyPixels(pixels.data(), raster.data(), size.x(), size.y(), rowSize, false, true);
+	return pixels;
 }
 
-Eigen::Vector2f SVGResource::getSourceImageSize() const
+void SVGResource::reload(std::shared_ptr<ResourceManager>& rm)
 {
-	if(mSVGImage)
-		return Eigen::Vector2f(mSVGImage->width, mSVGImage->height);
+	// (0, 0) is just the parsed SVG, nothing to draw
+	if(mSVGImage && !mMaxSize.isZero())
+	{
+		std::vector<unsigned char> pixels = rasterize(*mSVGImage, mMaxSize);
+		initFromPixels(pixels.data(), mMaxSize.x(), mMaxSize.y());
+	}
 
-	return Eigen::Vector2f::Zero();
+	mLoading = false;
 }
 
-void SVGResource::deinitSVG()
+Eigen::Vector2f SVGResource::getSourceImageSize() const
 {
 	if(mSVGImage)
-		nsvgDelete(mSVGImage);
+		return Eigen::Vector2f(mSVGImage->width, mSVGImage->height);
 
-	mSVGImage = NULL;
+	return Eigen::Vector2f::Zero();
 }
@@ -4,24 +4,35 @@
 
 struct NSVGimage;
 
+// An SVG rasterized at one size (getMaxSize()). These are shared and cached like any other texture (see TextureResource::get()),
+// and every size of the same SVG shares one parsed copy of it. One with a size of (0, 0) isn't rasterized at all, it's only
+// there for getSourceImageSize() - ImageComponent works out the size it's drawn at from that and gets that one instead.
 class SVGResource : public TextureResource
 {
 public:
 	virtual ~SVGResource();
 
-	virtual void unload(std::shared_ptr<ResourceManager>& rm) override;
-	
-	virtual void initFromMemory(const char* image, size_t length) override;
+	virtual void reload(std::shared_ptr<ResourceManager>& rm) override;
 
-	void rasterizeAt(size_t width, size_t height);
 	Eigen::Vector2f getSourceImageSize() const;
 
+	static bool isSVG(const std::string& path); // going by the extension
+
+	// Fills in a 0 in size from the other component so the aspect ratio is kept, (0, 0) means the SVG's own size.
+	static Eigen::Vector2i getRasterSize(const NSVGimage& image, const Eigen::Vector2i& size);
+
+	// Rasterizes image at exactly size. Rows are bottom to top, like ImageIO::loadFromMemoryRGBA32(). Thread safe.
+	static std::vector<unsigned char> rasterize(const NSVGimage& image, const Eigen::Vector2i& size);
+
 protected:
 	friend TextureResource;
-	SVGResource(const std::string& path, bool tile);
-	void deinitSVG();
+	SVGResource(const std::string& path, bool tile, const std::shared_ptr<NSVGimage>& image);
+
+	// Parses path, or hands back the copy that's already parsed if anything still has it. NULL if it can't be parsed.
+	// Main thread only.
+	static std::shared_ptr<NSVGimage> getImage(const std::string& path);
+
+	std::shared_ptr<NSVGimage> mSVGImage;
 
-	NSVGimage* mSVGImage;
-	size_t mLastWidth;
-	size_t mLastHeight;
+	static std::map< std::string, std::weak_ptr<NSVGimage> > sImages;
 };
@@ -0,0 +1,173 @@
+#include "resources/TextureAtlas.h"
+#include "Renderer.h"
+#include "Log.h"
+#include <assert.h>
+#include <string.h>
+
+// size of each (square) atlas page
+#define ATLAS_PAGE_SIZE 512
+
+// images bigger than this on either side get a texture of their own
+#define ATLAS_MAX_IMAGE_SIZE 128
+
+#define ATLAS_MAX_PAGES 4
+
+// each image's edge pixels are repeated this many times around it, so linear filtering never picks up its neighbours
+#define ATLAS_PADDING 1
+
+std::vector<TextureAtlas::Page> TextureAtlas::sPages;
+std::map<std::string, TextureAtlas::Entry> TextureAtlas::sEntries;
+
+bool TextureAtlas::allocate(Page& page, int width, int height, Eigen::Vector2i& pos)
+{
+	// doesn't fit on the current shelf, start a new one below it
+	if(page.shelfX + width > ATLAS_PAGE_SIZE)
+	{
+		page.shelfY += page.shelfHeight;
+		page.shelfX = 0;
+		page.shelfHeight = 0;
+	}
+
+	if(page.shelfY + height > ATLAS_PAGE_SIZE)
+		return false;
+
+	pos << page.shelfX, page.shelfY;
+	page.shelfX += width;
+	if(height > page.shelfHeight)
+		page.shelfHeight = height;
+
+	return true;
+}
+
+bool TextureAtlas::add(const std::string& key, const unsigned char* dataRGBA, size_t width, size_t height, Region& region)
+{
+	if(width == 0 || height == 0 || width > ATLAS_MAX_IMAGE_SIZE || height > ATLAS_MAX_IMAGE_SIZE)
+		return false;
+
+	auto existing = sEntries.find(key);
+	if(existing != sEntries.end())
+	{
+		existing->second.refs++;
+		sPages.at(existing->second.page).refs++;
+
+		region.key = key;
+		region.page = existing->second.page;
+		region.texRect = existing->second.texRect;
+		return true;
+	}
+
+	const int paddedWidth = (int)width + ATLAS_PADDING * 2;
+	const int paddedHeight = (int)height + ATLAS_PADDING * 2;
+
+	// find room on a page we already have, or start a new one
+	Eigen::Vector2i pos;
+	unsigned int pageIndex = 0;
+	for(; pageIndex < sPages.size(); pageIndex++)
+	{
+		if(sPages[pageIndex].textureID != 0 && allocate(sPages[pageIndex], paddedWidth, paddedHeight, pos))
+			break;
+	}
+
+	if(pageIndex == sPages.size())
+	{
+		for(pageIndex = 0; pageIndex < sPages.size(); pageIndex++)
+		{
+			if(sPages[pageIndex].textureID == 0)
+				break;
+		}
+
+		if(pageIndex == ATLAS_MAX_PAGES)
+			return false;
+
+		if(pageIndex == sPages.size())
+			sPages.push_back(Page());
+
+		Page& page = sPages[pageIndex];
+		page.refs = 0;
+		page.shelfX = 0;
+		page.shelfY = 0;
+		page.shelfHeight = 0;
+
+		glGenTextures(1, &page.textureID);
+		Renderer::bindTexture(page.textureID);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+		// same as TextureResource::initFromPixels()
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		LOG(LogDebug) << "Created texture atlas page " << pageIndex;
+
+		allocate(page, paddedWidth, paddedHeight, pos);
+	}
+
+	// copy the image over with its edges extended into the padding
+	std::vector<unsigned char> padded(paddedWidth * paddedHeight * 4);
+	for(int y = 0; y < paddedHeight; y++)
+	{
+		int srcY = y - ATLAS_PADDING;
+		srcY = srcY < 0 ? 0 : (srcY >= (int)height ? (int)height - 1 : srcY);
+
+		for(int x = 0; x < paddedWidth; x++)
+		{
+			int srcX = x - ATLAS_PADDING;
+			srcX = srcX < 0 ? 0 : (srcX >= (int)width ? (int)width - 1 : srcX);
+
+			memcpy(&padded[(y * paddedWidth + x) * 4], &dataRGBA[(srcY * width + srcX) * 4], 4);
+		}
+	}
+
+	Page& page = sPages[pageIndex];
+	Renderer::bindTexture(page.textureID);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x(), pos.y(), paddedWidth, paddedHeight, GL_RGBA, GL_UNSIGNED_BYTE, padded.data());
+	page.refs++;
+
+	Entry entry;
+	entry.page = pageIndex;
+	entry.texRect << (pos.x() + ATLAS_PADDING) / (float)ATLAS_PAGE_SIZE, (pos.y() + ATLAS_PADDING) / (float)ATLAS_PAGE_SIZE,
+		(pos.x() + ATLAS_PADDING + width) / (float)ATLAS_PAGE_SIZE, (pos.y() + ATLAS_PADDING + height) / (float)ATLAS_PAGE_SIZE;
+	entry.refs = 1;
+	sEntries[key] = entry;
+
+	region.key = key;
+	region.page = pageIndex;
+	region.texRect = entry.texRect;
+	return true;
+}
+
+void TextureAtlas::release(const Region& region)
+{
+	auto entry = sEntries.find(region.key);
+	assert(entry != sEntries.end());
+
+	// the space isn't reused until the whole page is free
+	if(--entry->second.refs == 0)
+		sEntries.erase(entry);
+
+	Page& page = sPages.at(region.page);
+	if(--page.refs == 0)
+	{
+		Renderer::deleteTexture(page.textureID);
+		page.textureID = 0;
+	}
+}
+
+GLuint TextureAtlas::getTextureID(unsigned int page)
+{
+	return sPages.at(page).textureID;
+}
+
+size_t TextureAtlas::getMemUsage()
+{
+	size_t total = 0;
+	for(auto it = sPages.begin(); it != sPages.end(); it++)
+	{
+		if(it->textureID != 0)
+			total += ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4;
+	}
+
+	return total;
+}
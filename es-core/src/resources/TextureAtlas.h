@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <Eigen/Dense>
+#include "platform.h"
+#include GLHEADER
+
+// Packs small images (the embedded UI icons, button/frame images etc.) into a few big textures, so drawing a screen
+// full of them doesn't need a texture bind per image. TextureResource puts embedded images in here on its own (see TextureResource::initFromPixels()).
+class TextureAtlas
+{
+public:
+	// Where an image ended up: which page (texture) it's on, and its texture coordinates there (x0, y0, x1, y1).
+	struct Region
+	{
+		std::string key;
+		unsigned int page;
+		Eigen::Vector4f texRect;
+	};
+
+	// Copies width x height RGBA pixels onto an atlas page and fills in region. Images added with the same key share a spot.
+	// Returns false if the image is too big for the atlas or there's no room left, in which case it needs a texture of its own.
+	static bool add(const std::string& key, const unsigned char* dataRGBA, size_t width, size_t height, Region& region);
+
+	// Lets go of a region from add(). A page is deleted once nothing on it is used anymore.
+	static void release(const Region& region);
+
+	static GLuint getTextureID(unsigned int page);
+	static size_t getMemUsage(); // in bytes
+
+private:
+	struct Page
+	{
+		GLuint textureID; // 0 if this page isn't in use
+		unsigned int refs;
+
+		// images are packed in rows ("shelves"), left to right
+		int shelfY;
+		int shelfHeight;
+		int shelfX;
+	};
+
+	struct Entry
+	{
+		unsigned int page;
+		Eigen::Vector4f texRect;
+		unsigned int refs;
+	};
+
+	static bool allocate(Page& page, int width, int height, Eigen::Vector2i& pos);
+
+	static std::vector<Page> sPages;
+	static std::map<std::string, Entry> sEntries;
+};
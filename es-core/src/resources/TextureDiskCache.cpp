@@ -0,0 +1,242 @@
+#include "resources/TextureDiskCache.h"
+#include "resources/ResourceManager.h"
+#include "ImageIO.h"
+#include "Log.h"
+#include "Settings.h"
+#include "platform.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <ctime>
+#include <stdint.h>
+#include <string.h>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace fs = boost::filesystem;
+namespace ip = boost::interprocess;
+
+// bump this if the file format changes - old entries are then ignored (and overwritten when the image is loaded again)
+#define CACHE_VERSION 1
+
+struct CacheHeader
+{
+	char magic[4]; // "ESTC"
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t keyLength; // followed by the key (so hash collisions can't hand back the wrong image), then the pixels
+};
+
+TextureDiskCache::Image::Image() : mPixels(NULL), mWidth(0), mHeight(0)
+{
+}
+
+TextureDiskCache::Image::~Image()
+{
+}
+
+bool TextureDiskCache::isCacheable(const std::string& path, const Eigen::Vector2i& maxSize)
+{
+	// embedded resources (":/...") are decoded from memory anyway
+	return !maxSize.isZero() && !path.empty() && path[0] != ':';
+}
+
+std::string TextureDiskCache::getKey(const std::string& path, const Eigen::Vector2i& maxSize)
+{
+	boost::system::error_code ec;
+	const std::time_t modified = fs::last_write_time(path, ec);
+	if(ec)
+		return "";
+
+	std::stringstream ss;
+	ss << path << "|" << modified << "|" << maxSize.x() << "x" << maxSize.y();
+	return ss.str();
+}
+
+std::string TextureDiskCache::getCacheDir()
+{
+	return getHomePath() + "/.emulationstation/texture_cache";
+}
+
+std::string TextureDiskCache::getCachePath(const std::string& key)
+{
+	std::stringstream ss;
+	ss << getCacheDir() << "/" << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>()(key) << ".tex";
+	return ss.str();
+}
+
+std::unique_ptr<TextureDiskCache::Image> TextureDiskCache::load(const std::string& path, const Eigen::Vector2i& maxSize)
+{
+	if(!isCacheable(path, maxSize))
+		return NULL;
+
+	const std::string key = getKey(path, maxSize);
+	if(key.empty())
+		return NULL;
+
+	const std::string cachePath = getCachePath(key);
+	boost::system::error_code ec;
+	if(!fs::exists(cachePath, ec))
+		return NULL;
+
+	std::unique_ptr<Image> image(new Image());
+	try
+	{
+		// the mapping stays valid after the file_mapping goes away
+		ip::file_mapping file(cachePath.c_str(), ip::read_only);
+		image->mRegion.reset(new ip::mapped_region(file, ip::read_only));
+	}catch(ip::interprocess_exception& e)
+	{
+		LOG(LogWarning) << "Could not map texture cache file \"" << cachePath << "\" - " << e.what();
+		return NULL;
+	}
+
+	const unsigned char* data = (const unsigned char*)image->mRegion->get_address();
+	const size_t size = image->mRegion->get_size();
+	if(size < sizeof(CacheHeader))
+		return NULL;
+
+	CacheHeader header;
+	memcpy(&header, data, sizeof(CacheHeader));
+	if(memcmp(header.magic, "ESTC", 4) != 0 || header.version != CACHE_VERSION || header.keyLength != key.size() ||
+		size != sizeof(CacheHeader) + header.keyLength + (size_t)header.width * header.height * 4 ||
+		memcmp(data + sizeof(CacheHeader), key.data(), key.size()) != 0)
+	{
+		return NULL;
+	}
+
+	// prune() goes by modification time, so mark it as recently used
+	fs::last_write_time(cachePath, std::time(NULL), ec);
+
+	image->mPixels = data + sizeof(CacheHeader) + header.keyLength;
+	image->mWidth = header.width;
+	image->mHeight = header.height;
+	return image;
+}
+
+void TextureDiskCache::save(const std::string& path, const Eigen::Vector2i& maxSize, const unsigned char* pixels, size_t width, size_t height)
+{
+	if(!isCacheable(path, maxSize))
+		return;
+
+	const std::string key = getKey(path, maxSize);
+	if(key.empty())
+		return;
+
+	const std::string cachePath = getCachePath(key);
+	boost::system::error_code ec;
+	fs::create_directories(fs::path(cachePath).parent_path(), ec);
+
+	// write it somewhere else first, so nothing ever maps a half-written file (this can be called for the same image from two threads)
+	const std::string tempPath = cachePath + "." + fs::unique_path().string() + ".tmp";
+
+	CacheHeader header;
+	memcpy(header.magic, "ESTC", 4);
+	header.version = CACHE_VERSION;
+	header.width = (uint32_t)width;
+	header.height = (uint32_t)height;
+	header.keyLength = (uint32_t)key.size();
+
+	std::ofstream out(tempPath.c_str(), std::ios::out | std::ios::binary);
+	out.write((const char*)&header, sizeof(CacheHeader));
+	out.write(key.data(), key.size());
+	out.write((const char*)pixels, width * height * 4);
+	out.close();
+
+	if(!out)
+	{
+		LOG(LogWarning) << "Could not write texture cache file \"" << tempPath << "\"";
+		fs::remove(tempPath, ec);
+		return;
+	}
+
+	fs::rename(tempPath, cachePath, ec);
+	if(ec)
+		fs::remove(tempPath, ec);
+}
+
+bool TextureDiskCache::prewarm(const std::string& path, const Eigen::Vector2i& maxSize)
+{
+	if(!isCacheable(path, maxSize))
+		return false;
+
+	if(load(path, maxSize))
+		return true;
+
+	const ResourceData data = ResourceManager::getInstance()->getFileData(path);
+	if(!data.ptr)
+		return false;
+
+	size_t width, height;
+	std::vector<unsigned char> pixels = ImageIO::loadFromMemoryRGBA32(data.ptr.get(), data.length, width, height, maxSize.x(), maxSize.y());
+	if(pixels.empty())
+		return false;
+
+	save(path, maxSize, pixels.data(), width, height);
+	return true;
+}
+
+void TextureDiskCache::prune()
+{
+	const int maxSizeMB = Settings::getInstance()->getInt("TextureCacheSize");
+	if(maxSizeMB <= 0)
+		return;
+
+	struct Entry
+	{
+		fs::path path;
+		std::time_t used;
+		uintmax_t size;
+	};
+
+	// this also picks up stale entries (old format, images that changed) and leftovers from interrupted writes,
+	// which aren't used anymore so they go first
+	std::vector<Entry> entries;
+	uintmax_t totalSize = 0;
+	boost::system::error_code ec;
+	for(fs::directory_iterator it(getCacheDir(), ec), end; !ec && it != end; it.increment(ec))
+	{
+		Entry entry;
+		entry.path = it->path();
+		entry.used = fs::last_write_time(entry.path, ec);
+		entry.size = fs::file_size(entry.path, ec);
+		if(ec)
+		{
+			ec.clear();
+			continue;
+		}
+
+		totalSize += entry.size;
+		entries.push_back(entry);
+	}
+
+	const uintmax_t maxSize = (uintmax_t)maxSizeMB * 1024 * 1024;
+	if(totalSize <= maxSize)
+		return;
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+
+	unsigned int removed = 0;
+	for(auto it = entries.begin(); it != entries.end() && totalSize > maxSize; it++)
+	{
+		if(fs::remove(it->path, ec))
+		{
+			totalSize -= it->size;
+			removed++;
+		}
+	}
+
+	LOG(LogInfo) << "Pruned " << removed << " entries from the texture cache, " << totalSize / (1024 * 1024) << "MB left";
+}
+
+void TextureDiskCache::clear()
+{
+	LOG(LogInfo) << "Deleting texture cache \"" << getCacheDir() << "\"";
+
+	boost::system::error_code ec;
+	fs::remove_all(getCacheDir(), ec);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <Eigen/Dense>
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+// Keeps already decoded and scaled down images on disk (in ~/.emulationstation/texture_cache), so the next time one is
+// wanted it can be memory-mapped and uploaded instead of decoded again. Entries are keyed by source path, modification time
+// and the size the image was scaled to fit, so changing the image or the theme just makes a new entry.
+// Only images that are scaled to fit a size (see TextureResource::get()) are cached - that's mostly scraped art, which is
+// small enough at display size that keeping it uncompressed is cheap. Everything here is safe to call from any thread.
+// The cache is kept under the TextureCacheSize setting (in megabytes) by prune(), which throws away the least recently used entries.
+class TextureDiskCache
+{
+public:
+	// A cached image, mapped into memory. The pixels are RGBA with rows bottom to top, like ImageIO::loadFromMemoryRGBA32().
+	class Image
+	{
+	public:
+		~Image();
+
+		inline const unsigned char* getPixels() const { return mPixels; }
+		inline size_t getWidth() const { return mWidth; }
+		inline size_t getHeight() const { return mHeight; }
+
+	private:
+		friend TextureDiskCache;
+		Image();
+
+		std::unique_ptr<boost::interprocess::mapped_region> mRegion;
+		const unsigned char* mPixels;
+		size_t mWidth;
+		size_t mHeight;
+	};
+
+	static bool isCacheable(const std::string& path, const Eigen::Vector2i& maxSize);
+
+	// Returns NULL if there's no (valid) entry for path at maxSize.
+	static std::unique_ptr<Image> load(const std::string& path, const Eigen::Vector2i& maxSize);
+
+	static void save(const std::string& path, const Eigen::Vector2i& maxSize, const unsigned char* pixels, size_t width, size_t height);
+
+	// Makes sure there's an entry for path at maxSize, decoding it if there isn't. Returns false if it couldn't be decoded.
+	static bool prewarm(const std::string& path, const Eigen::Vector2i& maxSize);
+
+	// Deletes the least recently used entries until the cache fits in TextureCacheSize. Goes through the whole
+	// directory, so call it when nothing's waiting on it (e.g. on exit).
+	static void prune();
+
+	// Deletes every entry (--rebuild-cache).
+	static void clear();
+
+private:
+	static std::string getCacheDir();
+	static std::string getCachePath(const std::string& key);
+	static std::string getKey(const std::string& path, const Eigen::Vector2i& maxSize); // empty if the source file is missing
+};
@@ -0,0 +1,48 @@
+#include "resources/TexturePrefetcher.h"
+#include "resources/TextureResource.h"
+
+unsigned int TexturePrefetcher::sHits = 0;
+unsigned int TexturePrefetcher::sMisses = 0;
+
+TexturePrefetcher::~TexturePrefetcher()
+{
+	clear();
+}
+
+void TexturePrefetcher::prefetch(const std::vector<std::string>& paths, const Eigen::Vector2i& maxSize)
+{
+	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
+
+	// grab the new set before letting go of the old one, so anything in both keeps loading
+	std::vector< std::shared_ptr<TextureResource> > textures;
+	textures.reserve(paths.size());
+	for(auto it = paths.begin(); it != paths.end(); it++)
+	{
+		if(it->empty() || !rm->fileExists(*it))
+			continue;
+
+		textures.push_back(TextureResource::get(*it, false, true, false, maxSize));
+	}
+
+	mTextures.swap(textures);
+	textures.clear();
+
+	TextureResource::cancelUnusedLoads();
+}
+
+void TexturePrefetcher::clear()
+{
+	if(mTextures.empty())
+		return;
+
+	mTextures.clear();
+	TextureResource::cancelUnusedLoads();
+}
+
+void TexturePrefetcher::countLanding(bool ready)
+{
+	if(ready)
+		sHits++;
+	else
+		sMisses++;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <Eigen/Dense>
+
+class TextureResource;
+
+// Keeps the textures for the entries around a list cursor decoding in the background, so when the cursor
+// lands on one its image is already there. Textures are loaded unpinned (see TextureResource::get()).
+class TexturePrefetcher
+{
+public:
+	~TexturePrefetcher();
+
+	// Replaces the set of textures we want ready with paths (empty or missing files are skipped).
+	// Anything that drops out of the set and hasn't finished decoding yet is cancelled.
+	// maxSize should match what the images will be shown with (see ImageComponent::getMaxTextureSize()), or they won't be reused.
+	void prefetch(const std::vector<std::string>& paths, const Eigen::Vector2i& maxSize);
+
+	// Same as prefetch() with nothing - e.g. while scrolling too fast for anything to be ready in time.
+	void clear();
+
+	// Call when the cursor lands on an entry with an image, with whether that image was ready to draw.
+	// Only used for the hit/miss counters, which are there to tune the "PrefetchCount" setting.
+	static void countLanding(bool ready);
+	inline static unsigned int getHits() { return sHits; }
+	inline static unsigned int getMisses() { return sMisses; }
+
+private:
+	std::vector< std::shared_ptr<TextureResource> > mTextures;
+
+	static unsigned int sHits;
+	static unsigned int sMisses;
+};
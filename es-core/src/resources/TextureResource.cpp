@@ -6,12 +6,31 @@
 #include "Renderer.h"
 #include "Util.h"
 #include "resources/SVGResource.h"
+#include "ThreadPool.h"
+#include "Settings.h"
+#include "resources/TextureDiskCache.h"
+#include <sstream>
+
+// how much decoded image data uploadLoadedTextures() sends to the GPU per frame (at least one image always goes through)
+#define UPLOAD_BUDGET_BYTES (4 * 1024 * 1024)
+
+// decoding is mostly CPU-bound, but leave some room for the main thread
+#define DECODE_THREADS 2
+
+// size hints are rounded up to a multiple of this (see TextureResource::get())
+#define SIZE_HINT_STEP 64
 
 std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sTextureMap;
-std::list< std::weak_ptr<TextureResource> > TextureResource::sTextureList;
+TextureResource::CacheList TextureResource::sCache;
+size_t TextureResource::sTotalMemUsage = 0;
+
+ThreadPool* TextureResource::sLoadPool = NULL;
+std::mutex TextureResource::sDecodedMutex;
+std::deque<TextureResource::DecodedImage> TextureResource::sDecoded;
+std::atomic<int> TextureResource::sPendingLoads(0);
 
 TextureResource::TextureResource(const std::string& path, bool tile) : 
-	mTextureID(0), mPath(path), mTextureSize(Eigen::Vector2i::Zero()), mTile(tile)
+	mTextureSize(Eigen::Vector2i::Zero()), mPath(path), mTile(tile), mMaxSize(Eigen::Vector2i::Zero()), mLoading(false), mTextureID(0), mAtlased(false), mTextureRect(0, 0, 1, 1), mPinned(true), mCached(false)
 {
 }
 
@@ -29,8 +48,198 @@ void TextureResource::reload(std::shared_ptr<ResourceManager>& rm)
 {
 	if(!mPath.empty())
 	{
-		const ResourceData& data = rm->getFileData(mPath);
-		initFromMemory((const char*)data.ptr.get(), data.length);
+		std::unique_ptr<TextureDiskCache::Image> cached = TextureDiskCache::load(mPath, mMaxSize);
+		if(cached)
+		{
+			initFromPixels(cached->getPixels(), cached->getWidth(), cached->getHeight());
+		}else{
+			const ResourceData& data = rm->getFileData(mPath);
+			initFromMemory((const char*)data.ptr.get(), data.length);
+		}
+
+		// if a background decode was still running, uploadLoadedTextures() will see we're already initialized and drop it
+		mLoading = false;
+	}
+}
+
+void TextureResource::queueLoad(const std::shared_ptr<TextureResource>& self)
+{
+	if(!sLoadPool)
+		sLoadPool = new ThreadPool(DECODE_THREADS);
+
+	mLoading = true;
+	sPendingLoads++;
+
+	// the worker only holds a weak_ptr - if nobody wants the texture by the time it gets to it (e.g. the cursor has already
+	// moved on), it doesn't bother decoding it. it never locks it either, so the texture can't end up being destroyed
+	// (and calling GL) off the main thread.
+	std::weak_ptr<TextureResource> texture = self;
+	const std::string path = mPath;
+	const Eigen::Vector2i maxSize = mMaxSize;
+
+	// SVGs get rasterized instead, from the copy that's already been parsed
+	std::shared_ptr<NSVGimage> svgImage;
+	SVGResource* svg = dynamic_cast<SVGResource*>(this);
+	if(svg)
+		svgImage = svg->mSVGImage;
+
+	sLoadPool->queueWork([texture, path, maxSize, svgImage] {
+		if(texture.expired())
+		{
+			sPendingLoads--;
+			return;
+		}
+
+		DecodedImage decoded;
+		decoded.texture = texture;
+		decoded.width = 0;
+		decoded.height = 0;
+
+		if(svgImage)
+		{
+			decoded.pixels = SVGResource::rasterize(*svgImage, maxSize);
+			decoded.width = maxSize.x();
+			decoded.height = maxSize.y();
+		}else if((decoded.cached = TextureDiskCache::load(path, maxSize)))
+		{
+			decoded.width = decoded.cached->getWidth();
+			decoded.height = decoded.cached->getHeight();
+		}else{
+			const ResourceData data = ResourceManager::getInstance()->getFileData(path);
+			if(data.ptr)
+				decoded.pixels = ImageIO::loadFromMemoryRGBA32(data.ptr.get(), data.length, decoded.width, decoded.height, maxSize.x(), maxSize.y());
+
+			if(!decoded.pixels.empty())
+				TextureDiskCache::save(path, maxSize, decoded.pixels.data(), decoded.width, decoded.height);
+		}
+
+		std::unique_lock<std::mutex> lock(sDecodedMutex);
+		sDecoded.push_back(std::move(decoded));
+	});
+}
+
+bool TextureResource::hasPendingLoads()
+{
+	return sPendingLoads > 0;
+}
+
+void TextureResource::shutdownLoader()
+{
+	if(!sLoadPool)
+		return;
+
+	// don't decode anything nobody's waiting for, the pool runs whatever's still queued before it stops
+	cancelUnusedLoads();
+
+	delete sLoadPool;
+	sLoadPool = NULL;
+
+	std::unique_lock<std::mutex> lock(sDecodedMutex);
+	sPendingLoads -= (int)sDecoded.size();
+	sDecoded.clear();
+}
+
+bool TextureResource::uploadLoadedTextures()
+{
+	size_t uploaded = 0;
+	while(uploaded < UPLOAD_BUDGET_BYTES)
+	{
+		DecodedImage decoded;
+		{
+			std::unique_lock<std::mutex> lock(sDecodedMutex);
+			if(sDecoded.empty())
+				break;
+
+			decoded = std::move(sDecoded.front());
+			sDecoded.pop_front();
+		}
+
+		sPendingLoads--;
+
+		std::shared_ptr<TextureResource> tex = decoded.texture.lock();
+		if(!tex || !tex->mLoading)
+			continue;
+
+		tex->mLoading = false;
+
+		const unsigned char* pixels = decoded.cached ? decoded.cached->getPixels() : decoded.pixels.data();
+		if(decoded.width == 0 || decoded.height == 0)
+		{
+			LOG(LogError) << "Could not initialize texture, invalid data!  (file path: " << tex->mPath << ")";
+			continue;
+		}
+
+		tex->initFromPixels(pixels, decoded.width, decoded.height);
+		uploaded += decoded.width * decoded.height * 4;
+	}
+
+	if(!uploaded)
+		return false;
+
+	evictUnused();
+	return true;
+}
+
+void TextureResource::touch(const std::shared_ptr<TextureResource>& self)
+{
+	if(mCached)
+	{
+		sCache.splice(sCache.begin(), sCache, mCacheIt);
+	}else{
+		sCache.push_front(self);
+		mCacheIt = sCache.begin();
+		mCached = true;
+	}
+}
+
+void TextureResource::evictUnused()
+{
+	evictUnused((size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024);
+}
+
+void TextureResource::clearCache()
+{
+	evictUnused(0);
+}
+
+void TextureResource::cancelUnusedLoads()
+{
+	auto it = sCache.begin();
+	while(it != sCache.end())
+	{
+		if(it->use_count() > 1 || !(*it)->isLoading())
+		{
+			it++;
+			continue;
+		}
+
+		// the worker only holds a weak_ptr, so once this goes it'll skip the decode (or uploadLoadedTextures() will drop it)
+		TextureKeyType key = (*it)->getKey();
+		it = sCache.erase(it);
+		sTextureMap.erase(key);
+	}
+}
+
+void TextureResource::evictUnused(size_t budget)
+{
+	// unpinned textures go first, then pinned ones
+	for(int pass = 0; pass < 2 && (sTotalMemUsage > budget || budget == 0); pass++)
+	{
+		const bool evictPinned = (pass == 1);
+
+		auto it = sCache.end();
+		while(it != sCache.begin() && (sTotalMemUsage > budget || budget == 0))
+		{
+			--it;
+
+			// still in use (we're not the only owner), or going to be soon
+			if(it->use_count() > 1 || (*it)->mPinned != evictPinned || (*it)->isLoading())
+				continue;
+
+			TextureKeyType key = (*it)->getKey();
+			it = sCache.erase(it); // last reference, frees the texture
+			sTextureMap.erase(key);
+		}
 	}
 }
 
@@ -40,9 +249,27 @@ void TextureResource::initFromPixels(const unsigned char* dataRGBA, size_t width
 
 	assert(width > 0 && height > 0);
 
+	mTextureSize << width, height;
+
+	// small embedded images (icons, buttons, frames...) share a few atlas textures, so drawing a bunch of them doesn't
+	// mean binding a new texture for each one. tiling needs a texture to itself.
+	if(!mTile && mPath.size() > 2 && mPath[0] == ':')
+	{
+		std::stringstream key;
+		key << mPath << "@" << width << "x" << height;
+		if(TextureAtlas::add(key.str(), dataRGBA, width, height, mAtlasRegion))
+		{
+			mAtlased = true;
+			mTextureRect = mAtlasRegion.texRect;
+			return;
+		}
+	}
+
+	sTotalMemUsage += width * height * 4;
+
 	//now for the openGL texture stuff
 	glGenTextures(1, &mTextureID);
-	glBindTexture(GL_TEXTURE_2D, mTextureID);
+	Renderer::bindTexture(mTextureID);
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, dataRGBA);
 
@@ -52,14 +279,12 @@ void TextureResource::initFromPixels(const unsigned char* dataRGBA, size_t width
 	const GLint wrapMode = mTile ? GL_REPEAT : GL_CLAMP_TO_EDGE;
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
-
-	mTextureSize << width, height;
 }
 
 void TextureResource::initFromMemory(const char* data, size_t length)
 {
 	size_t width, height;
-	std::vector<unsigned char> imageRGBA = ImageIO::loadFromMemoryRGBA32((const unsigned char*)(data), length, width, height);
+	std::vector<unsigned char> imageRGBA = ImageIO::loadFromMemoryRGBA32((const unsigned char*)(data), length, width, height, mMaxSize.x(), mMaxSize.y());
 
 	if(imageRGBA.size() == 0)
 	{
@@ -68,15 +293,24 @@ void TextureResource::initFromMemory(const char* data, size_t length)
 	}
 
 	initFromPixels(imageRGBA.data(), width, height);
+	TextureDiskCache::save(mPath, mMaxSize, imageRGBA.data(), width, height);
 }
 
 void TextureResource::deinit()
 {
 	if(mTextureID != 0)
 	{
-		glDeleteTextures(1, &mTextureID);
+		sTotalMemUsage -= getMemUsage();
+		Renderer::deleteTexture(mTextureID);
 		mTextureID = 0;
 	}
+
+	if(mAtlased)
+	{
+		TextureAtlas::release(mAtlasRegion);
+		mAtlased = false;
+		mTextureRect << 0, 0, 1, 1;
+	}
 }
 
 const Eigen::Vector2i& TextureResource::getSize() const
@@ -89,16 +323,33 @@ bool TextureResource::isTiled() const
 	return mTile;
 }
 
-void TextureResource::bind() const
+GLuint TextureResource::getTextureID() const
 {
-	if(mTextureID != 0)
-		glBindTexture(GL_TEXTURE_2D, mTextureID);
-	else
-		LOG(LogError) << "Tried to bind uninitialized texture!";
+	if(mAtlased)
+		return TextureAtlas::getTextureID(mAtlasRegion.page);
+
+	return mTextureID;
 }
 
 
-std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile)
+static int roundSizeHint(int size)
+{
+	if(size <= 0)
+		return 0;
+
+	return ((size + SIZE_HINT_STEP - 1) / SIZE_HINT_STEP) * SIZE_HINT_STEP;
+}
+
+bool TextureResource::prewarm(const std::string& path, const Eigen::Vector2i& maxSize)
+{
+	const std::string canonicalPath = getCanonicalPath(path);
+	if(SVGResource::isSVG(canonicalPath))
+		return false;
+
+	return TextureDiskCache::prewarm(canonicalPath, Eigen::Vector2i(roundSizeHint(maxSize.x()), roundSizeHint(maxSize.y())));
+}
+
+std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile, bool async, bool pinned, const Eigen::Vector2i& maxSize)
 {
 	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
 
@@ -111,41 +362,88 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 		return tex;
 	}
 
-	TextureKeyType key(canonicalPath, tile);
+	const bool isSVG = SVGResource::isSVG(canonicalPath);
+
+	// tiling depends on the real image size, and SVGs are rasterized at exactly the size they're drawn at
+	Eigen::Vector2i bucket = Eigen::Vector2i::Zero();
+	std::shared_ptr<NSVGimage> svgImage;
+	if(isSVG)
+	{
+		svgImage = SVGResource::getImage(canonicalPath);
+		if(!svgImage)
+		{
+			std::shared_ptr<TextureResource> tex(new TextureResource("", tile));
+			rm->addReloadable(tex);
+			return tex;
+		}
+
+		if(!maxSize.isZero())
+			bucket = SVGResource::getRasterSize(*svgImage, maxSize);
+	}else if(!tile)
+	{
+		bucket << roundSizeHint(maxSize.x()), roundSizeHint(maxSize.y());
+	}
+
+	TextureKeyType key(canonicalPath, tile, bucket.x(), bucket.y());
 	auto foundTexture = sTextureMap.find(key);
 	if(foundTexture != sTextureMap.end())
 	{
 		if(!foundTexture->second.expired())
-			return foundTexture->second.lock();
+		{
+			std::shared_ptr<TextureResource> tex = foundTexture->second.lock();
+			tex->touch(tex);
+
+			// if anyone wants it pinned, it's pinned
+			if(pinned)
+				tex->mPinned = true;
+
+			// someone else is loading it in the background, but we need it now
+			if(!async && tex->isLoading())
+			{
+				tex->reload(rm);
+				evictUnused();
+			}
+
+			return tex;
+		}
 	}
 
 	// need to create it
 	std::shared_ptr<TextureResource> tex;
+	if(isSVG)
+		tex = std::shared_ptr<SVGResource>(new SVGResource(canonicalPath, tile, svgImage));
+	else
+		tex = std::shared_ptr<TextureResource>(new TextureResource(canonicalPath, tile));
+
+	tex->mMaxSize = bucket;
+	sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
+	rm->addReloadable(tex);
 
-	// is it an SVG?
-	if(key.first.substr(key.first.size() - 4, std::string::npos) == ".svg")
+	tex->mPinned = pinned;
+	tex->touch(tex);
+
+	// an SVG with no size is only there to be measured, but it can still tell you its own size
+	if(isSVG)
 	{
-		// probably
-		// don't add it to our map because 2 svgs might be rasterized at different sizes
-		tex = std::shared_ptr<SVGResource>(new SVGResource(key.first, tile));
-		sTextureList.push_back(tex); // add it to our list though
-		rm->addReloadable(tex);
-		tex->reload(rm);
-		return tex;
+		tex->mTextureSize = SVGResource::getRasterSize(*svgImage, bucket);
+		if(bucket.isZero())
+			return tex;
+	}
+
+	if(async)
+	{
+		tex->queueLoad(tex);
 	}else{
-		// normal texture
-		tex = std::shared_ptr<TextureResource>(new TextureResource(key.first, tile));
-		sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
-		sTextureList.push_back(tex);
-		rm->addReloadable(tex);
 		tex->reload(ResourceManager::getInstance());
-		return tex;
+		evictUnused();
 	}
+
+	return tex;
 }
 
 bool TextureResource::isInitialized() const
 {
-	return mTextureID != 0;
+	return mTextureID != 0 || mAtlased;
 }
 
 size_t TextureResource::getMemUsage() const
@@ -158,21 +456,10 @@ size_t TextureResource::getMemUsage() const
 
 size_t TextureResource::getTotalMemUsage()
 {
-	size_t total = 0;
-
-	auto it = sTextureList.begin();
-	while(it != sTextureList.end())
-	{
-		if((*it).expired())
-		{
-			// remove expired textures from the list
-			it = sTextureList.erase(it);
-			continue;
-		}
-
-		total += (*it).lock()->getMemUsage();
-		it++;
-	}
+	return sTotalMemUsage + TextureAtlas::getMemUsage();
+}
 
-	return total;
+size_t TextureResource::getCacheSize()
+{
+	return sCache.size();
 }
@@ -1,18 +1,56 @@
 #pragma once
 
 #include "resources/ResourceManager.h"
+#include "resources/TextureDiskCache.h"
+#include "resources/TextureAtlas.h"
 
 #include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <tuple>
 #include <Eigen/Dense>
 #include "platform.h"
 #include GLHEADER
 
+class ThreadPool;
+
 // An OpenGL texture.
 // Automatically recreates the texture with renderer deinit/reinit.
 class TextureResource : public IReloadable
 {
 public:
-	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false);
+	// Images that get scaled down are kept decoded in TextureDiskCache, so they only have to be decoded once.
+	// If async is true, the file is read and decoded on a worker thread and the texture stays uninitialized
+	// (isLoading() returns true) until uploadLoadedTextures() uploads it. SVGs are always parsed right away (so their
+	// size is known), but rasterizing them goes by async like decoding does - sized ones are rasterized on a worker thread.
+	// Textures loaded from a file are cached for a while after the last reference goes away. When the cache
+	// goes over the "MaxVRAM" setting, the least recently used ones are dropped - unpinned ones (e.g. gamelist art)
+	// first, pinned ones (theme/UI textures) only if that isn't enough. Textures that are still in use are never dropped.
+	// If maxSize is set (either component can be 0 for "any"), bigger images are scaled down on load to fit in it. It gets
+	// rounded up a bit so components that want nearly the same size share a texture - the texture can still end up smaller
+	// than maxSize, so size things with getSize(). Tiled textures are always loaded at full size.
+	// SVGs (see SVGResource) are rasterized at exactly maxSize instead, and are shared and cached per size the same way.
+	// If one component of maxSize is 0 it's worked out from the aspect ratio. With no maxSize an SVG is only parsed.
+	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false, bool async = false, bool pinned = true,
+		const Eigen::Vector2i& maxSize = Eigen::Vector2i::Zero());
+
+	// Decodes path into TextureDiskCache the way get() with maxSize would load it, without making a texture (for
+	// pre-warming the cache). Returns false if it isn't something that gets cached or couldn't be decoded. Thread safe.
+	static bool prewarm(const std::string& path, const Eigen::Vector2i& maxSize);
+
+	// Uploads textures that have finished decoding in the background, up to a per-frame budget. Returns true if anything
+	// was uploaded (so there's something new to draw). Must be called from the main thread (Window does it every update).
+	static bool uploadLoadedTextures();
+
+	// True while there are background loads that haven't made it through uploadLoadedTextures() yet.
+	static bool hasPendingLoads();
+
+	// Finishes (or skips, if nothing wants the texture anymore) every queued background load and stops the worker threads,
+	// throwing away whatever hasn't been uploaded. Call it from the main thread on exit, before anything the workers use
+	// (e.g. TextureDiskCache) is cleaned up. Loading again afterwards starts new workers.
+	static void shutdownLoader();
 
 	virtual ~TextureResource();
 
@@ -20,9 +58,16 @@ public:
 	virtual void reload(std::shared_ptr<ResourceManager>& rm) override;
 	
 	bool isInitialized() const;
+
+	// Where the image is in the texture getTextureID() returns, in texture coordinates (x0, y0, x1, y1) - (0, 0, 1, 1) unless
+	// it's been put in a TextureAtlas (embedded images small enough for it are, unless they're tiled).
+	inline const Eigen::Vector4f& getTextureRect() const { return mTextureRect; }
+	inline bool isLoading() const { return mLoading; }
 	bool isTiled() const;
 	const Eigen::Vector2i& getSize() const;
-	void bind() const;
+	inline const std::string& getPath() const { return mPath; }
+	inline const Eigen::Vector2i& getMaxSize() const { return mMaxSize; } // what the image was scaled down to fit on load (or rasterized at), (0, 0) if it wasn't
+	GLuint getTextureID() const; // what to draw with (see Renderer::drawTriangles()), 0 if it isn't initialized
 	
 	// Warning: will NOT correctly reinitialize when this texture is reloaded (e.g. ES starts/stops playing a game).
 	virtual void initFromMemory(const char* file, size_t length);
@@ -30,8 +75,16 @@ public:
 	// Warning: will NOT correctly reinitialize when this texture is reloaded (e.g. ES starts/stops playing a game).
 	void initFromPixels(const unsigned char* dataRGBA, size_t width, size_t height);
 
-	size_t getMemUsage() const; // returns an approximation of the VRAM used by this texture (in bytes)
-	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by textures (in bytes)
+	size_t getMemUsage() const; // returns an approximation of the VRAM used by this texture (in bytes), 0 if it's in an atlas
+	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by textures (in bytes), atlases included
+	static size_t getCacheSize(); // number of textures being kept alive by the cache (in use or not)
+
+	// Drops cached textures that are still waiting on a background decode but that nothing holds anymore (e.g. the
+	// cursor has already moved past them), so the decode is skipped instead of holding up the ones that are wanted.
+	static void cancelUnusedLoads();
+
+	// Drops every cached texture that isn't in use, e.g. before the renderer goes away (so they don't all get reloaded when it comes back).
+	static void clearCache();
 
 protected:
 	TextureResource(const std::string& path, bool tile);
@@ -40,12 +93,47 @@ protected:
 	Eigen::Vector2i mTextureSize;
 	const std::string mPath;
 	const bool mTile;
+	Eigen::Vector2i mMaxSize; // (0, 0) = full size
+	bool mLoading; // waiting on a background decode
 
 private:
 	GLuint mTextureID;
+	bool mAtlased; // in mAtlasRegion instead of mTextureID
+	TextureAtlas::Region mAtlasRegion;
+	Eigen::Vector4f mTextureRect;
+
+	struct DecodedImage
+	{
+		std::weak_ptr<TextureResource> texture;
+		std::vector<unsigned char> pixels; // freshly decoded, or...
+		std::unique_ptr<TextureDiskCache::Image> cached; // ...loaded from the disk cache
+		size_t width;
+		size_t height;
+	};
+
+	void queueLoad(const std::shared_ptr<TextureResource>& self);
+
+	static ThreadPool* sLoadPool;
+	static std::mutex sDecodedMutex;
+	static std::deque<DecodedImage> sDecoded; // finished by the pool, waiting for uploadLoadedTextures()
+	static std::atomic<int> sPendingLoads; // queued and not through uploadLoadedTextures() yet (or skipped)
 
-	typedef std::pair<std::string, bool> TextureKeyType;
+	typedef std::tuple<std::string, bool, int, int> TextureKeyType; // path, tile, max size
+	inline TextureKeyType getKey() const { return TextureKeyType(mPath, mTile, mMaxSize.x(), mMaxSize.y()); }
 	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sTextureMap; // map of textures, used to prevent duplicate textures
 
-	static std::list< std::weak_ptr<TextureResource> > sTextureList; // list of all textures, used for memory approximations
+	// marks this texture as the most recently used one in the cache
+	void touch(const std::shared_ptr<TextureResource>& self);
+
+	// drops least recently used textures nobody else is holding until we're back under budget (in bytes)
+	static void evictUnused(size_t budget);
+	static void evictUnused();
+
+	typedef std::list< std::shared_ptr<TextureResource> > CacheList;
+	static CacheList sCache; // most recently used first
+	bool mPinned;
+	bool mCached;
+	CacheList::iterator mCacheIt;
+
+	static size_t sTotalMemUsage; // kept up to date by initFromPixels() and deinit()
 };